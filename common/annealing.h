@@ -0,0 +1,189 @@
+#pragma once
+
+// Flow-shop pieces of simulated annealing (lab4): swap, insertion and block-move
+// neighbourhoods scored incrementally from head/tail matrices (with the whole insertion
+// neighbourhood in one scan for tabu search), and the temperature calibration. The annealing loop itself is meta::anneal (metaheuristics.h), run on
+// meta::FlowShopProblem (problems.h) by lab4 and the solver daemon.
+// Randomness comes from the caller's engine (moves.h), seeded for reproducible runs.
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "flowshop.h"
+#include "instrumentation.h"
+#include "metaheuristics.h"
+#include "moves.h"
+
+inline std::vector<int> shuffleOrder(const std::vector<int>& originalOrder, Random& random) {
+    std::vector<int> modifiedOrder = originalOrder;
+    int size = static_cast<int>(originalOrder.size());
+    int firstPosition = randomBelow(random, size);
+    int secondPosition;
+    do {
+        secondPosition = randomBelow(random, size);
+    } while (firstPosition == secondPosition);
+    std::swap(modifiedOrder[firstPosition], modifiedOrder[secondPosition]);
+    return modifiedOrder;
+}
+
+// Keeps head and tail completion matrices of the current sequence so that a move
+// is scored by recomputing only the positions it touches
+class IncrementalEvaluator {
+public:
+    IncrementalEvaluator(const flowshop::InstanceView& units, const std::vector<int>& sequence)
+        : units(units), sequence(sequence), unitCount(sequence.size()), machineCount(units.machineCount),
+          heads((unitCount + 1) * machineCount, 0), tails((unitCount + 1) * machineCount, 0),
+          window(unitCount), scratch(machineCount) {
+        flowshop::computeHeads(units, this->sequence.data(), unitCount, heads.data());
+        flowshop::computeTails(units, this->sequence.data(), unitCount, tails.data());
+    }
+
+    int makespan() const {
+        return heads[unitCount * machineCount + machineCount - 1];
+    }
+
+    const std::vector<int>& currentSequence() const {
+        return sequence;
+    }
+
+    // Replaces the sequence and rebuilds both matrices
+    void reset(const std::vector<int>& newSequence) {
+        sequence = newSequence;
+        flowshop::computeHeads(units, sequence.data(), unitCount, heads.data());
+        flowshop::computeTails(units, sequence.data(), unitCount, tails.data());
+    }
+
+    int evaluate(const Move& move) {
+        INSTRUMENT_PHASE(Evaluate);
+        INSTRUMENT_COUNT(MakespanEvaluations);
+        int length = move.last - move.first + 1;
+        std::copy(sequence.begin() + move.first, sequence.begin() + move.last + 1, window.begin());
+        if (move.type == MoveType::Swap) {
+            std::swap(window[0], window[length - 1]);
+        } else {
+            std::rotate(window.begin(), window.begin() + move.shift, window.begin() + length);
+        }
+
+        std::copy(heads.begin() + move.first * machineCount, heads.begin() + (move.first + 1) * machineCount, scratch.begin());
+        flowshop::propagateRow(units, window.data(), length, scratch.data());
+        int maxDuration = 0;
+        const int* tail = &tails[(move.last + 1) * machineCount];
+        for (int m = 0; m < machineCount; m++) {
+            maxDuration = std::max(maxDuration, scratch[m] + tail[m]);
+        }
+        return maxDuration;
+    }
+
+    void accept(const Move& move) {
+        applyMove(sequence, move);
+        flowshop::computeHeads(units, sequence.data(), unitCount, heads.data(), move.first);
+        flowshop::computeTails(units, sequence.data(), unitCount, tails.data(), move.last);
+    }
+
+    // Calls visit(from, to, makespan) for every insertionMove(from, to) except to == from and
+    // to == from - 1, in from-major order. Each job is removed once and all its reinsertion
+    // points are scored in one O(n * m) pass over the heads/tails of the shortened sequence
+    // (Taillard's acceleration), so the whole neighbourhood costs O(n^2 * m).
+    template <typename Visit>
+    void scanInsertions(Visit&& visit) {
+        if (unitCount < 2) {
+            return;
+        }
+        reduced.resize(unitCount - 1);
+        reducedHeads.resize(unitCount * machineCount);
+        reducedTails.resize(unitCount * machineCount);
+        for (int from = 0; from < unitCount; from++) {
+            int job = sequence[from];
+            std::copy(sequence.begin(), sequence.begin() + from, reduced.begin());
+            std::copy(sequence.begin() + from + 1, sequence.end(), reduced.begin() + from);
+
+            // heads up to `from` and tails after it are those of the full sequence, shifted for tails
+            std::copy(heads.begin(), heads.begin() + (from + 1) * machineCount, reducedHeads.begin());
+            flowshop::computeHeads(units, reduced.data(), unitCount - 1, reducedHeads.data(), from);
+            std::copy(tails.begin() + (from + 1) * machineCount, tails.end(), reducedTails.begin() + from * machineCount);
+            flowshop::computeTails(units, reduced.data(), unitCount - 1, reducedTails.data(), from - 1);
+
+            INSTRUMENT_PHASE(Evaluate);
+            INSTRUMENT_ADD(MakespanEvaluations, unitCount - 2 + (from == 0));
+            for (int to = 0; to < unitCount; to++) {
+                if (to == from || to == from - 1) {
+                    continue;
+                }
+                visit(from, to, flowshop::insertionMakespan(units, job, reducedHeads.data(), reducedTails.data(), to));
+            }
+        }
+    }
+
+private:
+    flowshop::InstanceView units;
+    std::vector<int> sequence;
+    int unitCount;
+    int machineCount;
+    std::vector<int> heads;
+    std::vector<int> tails;
+    std::vector<int> window;
+    std::vector<int> scratch;
+    std::vector<int> reduced; // scanInsertions scratch, sized on first use
+    std::vector<int> reducedHeads;
+    std::vector<int> reducedTails;
+};
+
+inline std::pair<double, double> defineTemperatures(int maxChange, int minChange) {
+    if (maxChange <= 0 || minChange <= 0) {
+        throw std::invalid_argument("maxChange and minChange must be greater than 0.");
+    }
+    double upperTemp = -maxChange / std::log(0.9);
+    double lowerTemp = -minChange / std::log(0.1);
+    return {upperTemp, lowerTemp};
+}
+
+inline double determineCoolingRate(double upperTemp, double lowerTemp, int cycles) {
+    if (upperTemp <= 0 || lowerTemp <= 0) {
+        throw std::invalid_argument("upperTemp and lowerTemp must be greater than 0.");
+    }
+    return std::pow(lowerTemp / upperTemp, 1.0 / cycles);
+}
+
+inline std::pair<int, int> computeDeltaExtremes(const flowshop::InstanceView& units, int alterations, Random& random) {
+    std::vector<int> sequence(units.jobCount);
+    for (size_t i = 0; i < sequence.size(); i++) sequence[i] = i;
+
+    int currentMax = flowshop::makespan(units, sequence);
+    int maxDelta = INT_MIN;
+    int minDelta = INT_MAX;
+
+    for (int i = 0; i < alterations; i++) {
+        std::vector<int> newSequence = shuffleOrder(sequence, random);
+        int newMax = flowshop::makespan(units, newSequence);
+        int delta = std::abs(newMax - currentMax);
+
+        if (delta >= maxDelta) maxDelta = delta;
+        if (delta <= minDelta) minDelta = delta;
+
+        currentMax = newMax;
+    }
+
+    if (minDelta == 0) minDelta = 1;
+    return {maxDelta, minDelta};
+}
+
+// Temperatures for `iterations` annealing steps on `units`: from the spread of makespan
+// changes under 1000 random swaps, hot enough to accept the largest change with
+// probability 0.9 at the start and cold enough to accept the smallest with 0.1 at the end.
+// Throws std::invalid_argument when every permutation has the same makespan.
+inline meta::AnnealingSettings calibrateAnnealing(const flowshop::InstanceView& units, long long iterations, const MoveMix& mix,
+                                                  Random& random) {
+    auto extremes = computeDeltaExtremes(units, 1000, random);
+    auto temps = defineTemperatures(extremes.first, extremes.second);
+    meta::AnnealingSettings settings;
+    settings.iterations = iterations;
+    settings.initialTemperature = temps.first;
+    settings.finalTemperature = temps.second;
+    settings.mix = mix;
+    return settings;
+}
@@ -0,0 +1,406 @@
+#pragma once
+
+// Benchmark harness shared by the labs: warm-up runs, repeated timing with
+// median/p95/min per (algorithm, instance size) cell, hardware counters through
+// perf_event_open where the kernel allows it, and a JSON baseline used to fail
+// runs in which a kernel got slower than a threshold.
+//
+// Every lab accepts the same flags next to its normal output mode:
+//   --benchmark                 run the benchmark instead of the normal report
+//   --warmup N --repetitions N  runs discarded / measured per cell
+//   --min-sample SECONDS        batch fast bodies until a sample lasts this long
+//   --save-baseline FILE        write the measured cells as JSON
+//   --baseline FILE             compare against FILE, exit code 1 on regression
+//   --threshold X               allowed relative median slowdown (default 0.10)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace benchmark {
+
+struct Options {
+    bool enabled = false;
+    int warmup = 2;
+    int repetitions = 10;
+    double threshold = 0.10;
+    double minSampleSeconds = 0.01;
+    std::string baselinePath;
+    std::string saveBaselinePath;
+};
+
+namespace detail {
+
+// Parses the whole of `text` as a number; false (and `value` untouched) otherwise
+inline bool parseNumber(const std::string& text, double& value) {
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    double parsed = std::strtod(begin, &end);
+    if (end == begin || *end != '\0') {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// Reads the value of `option`; an invalid one is reported and the default kept
+template <typename T>
+void parseOption(const std::string& option, const char* text, T& value) {
+    double parsed;
+    if (parseNumber(text, parsed)) {
+        value = static_cast<T>(parsed);
+    } else {
+        std::cerr << "Ignoring invalid value for " << option << ": " << text << std::endl;
+    }
+}
+
+} // namespace detail
+
+inline Options parseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--benchmark") {
+            options.enabled = true;
+        } else if (argument == "--warmup" && hasValue) {
+            detail::parseOption(argument, argv[++i], options.warmup);
+        } else if (argument == "--repetitions" && hasValue) {
+            detail::parseOption(argument, argv[++i], options.repetitions);
+            options.repetitions = std::max(1, options.repetitions);
+        } else if (argument == "--min-sample" && hasValue) {
+            detail::parseOption(argument, argv[++i], options.minSampleSeconds);
+        } else if (argument == "--threshold" && hasValue) {
+            detail::parseOption(argument, argv[++i], options.threshold);
+        } else if (argument == "--baseline" && hasValue) {
+            options.baselinePath = argv[++i];
+            options.enabled = true;
+        } else if (argument == "--save-baseline" && hasValue) {
+            options.saveBaselinePath = argv[++i];
+            options.enabled = true;
+        }
+    }
+    return options;
+}
+
+// Keeps the compiler from discarding a result that is computed only to be timed
+template <typename T>
+inline void keep(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Instructions and cycles of the calling thread; inert when perf_event_open is unavailable
+class PerfCounters {
+public:
+    PerfCounters() {
+#if defined(__linux__)
+        leader = open(PERF_COUNT_HW_INSTRUCTIONS, -1);
+        if (leader >= 0) {
+            follower = open(PERF_COUNT_HW_CPU_CYCLES, leader);
+            if (follower < 0) {
+                close(leader);
+                leader = -1;
+            }
+        }
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        if (follower >= 0) {
+            close(follower);
+        }
+        if (leader >= 0) {
+            close(leader);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const {
+        return leader >= 0;
+    }
+
+    void start() {
+#if defined(__linux__)
+        if (available()) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    // Returns false when the counters could not be read
+    bool stop(long long& instructions, long long& cycles) {
+#if defined(__linux__)
+        if (available()) {
+            ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            uint64_t values[3] = {0, 0, 0};
+            if (read(leader, values, sizeof(values)) == static_cast<ssize_t>(sizeof(values)) && values[0] == 2) {
+                instructions = static_cast<long long>(values[1]);
+                cycles = static_cast<long long>(values[2]);
+                return true;
+            }
+        }
+#endif
+        instructions = -1;
+        cycles = -1;
+        return false;
+    }
+
+private:
+#if defined(__linux__)
+    static int open(uint64_t config, int groupLeader) {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = config;
+        attributes.disabled = groupLeader < 0 ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupLeader, 0));
+    }
+#endif
+
+    int leader = -1;
+    int follower = -1;
+};
+
+struct Cell {
+    std::string algorithm;
+    std::string size;
+    int repetitions = 0;
+    double median = 0; // seconds
+    double p95 = 0;
+    double min = 0;
+    long long instructions = -1; // median per repetition, -1 when not measured
+    long long cycles = -1;
+};
+
+namespace detail {
+
+inline double percentile(std::vector<double> samples, double fraction) {
+    std::sort(samples.begin(), samples.end());
+    size_t index = static_cast<size_t>(fraction * (samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+inline long long medianCount(std::vector<long long> samples) {
+    if (samples.empty()) {
+        return -1;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+inline std::string field(const std::string& object, const std::string& key) {
+    std::string pattern = "\"" + key + "\":";
+    size_t position = object.find(pattern);
+    if (position == std::string::npos) {
+        return "";
+    }
+    position += pattern.size();
+    while (position < object.size() && object[position] == ' ') {
+        position++;
+    }
+    if (position < object.size() && object[position] == '"') {
+        size_t close = object.find('"', position + 1);
+        return object.substr(position + 1, close - position - 1);
+    }
+    size_t close = object.find_first_of(",}", position);
+    return object.substr(position, close - position);
+}
+
+inline std::string formatSeconds(double seconds) {
+    std::ostringstream out;
+    if (seconds < 1e-3) {
+        out << std::fixed << std::setprecision(2) << seconds * 1e6 << " us";
+    } else if (seconds < 1) {
+        out << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms";
+    } else {
+        out << std::fixed << std::setprecision(3) << seconds << " s";
+    }
+    return out.str();
+}
+
+} // namespace detail
+
+class Suite {
+public:
+    explicit Suite(const Options& options) : options(options) {}
+
+    // Runs `body` warmup + repetitions times and records one cell. Bodies faster than
+    // minSampleSeconds are batched so that each sample spans at least that long.
+    template <typename Body>
+    const Cell& measure(const std::string& algorithm, const std::string& size, Body&& body) {
+        auto warmupStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.warmup; i++) {
+            body();
+        }
+        double warmupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - warmupStart).count();
+        int batch = 1;
+        if (options.warmup > 0 && warmupSeconds > 0) {
+            double perRun = warmupSeconds / options.warmup;
+            batch = static_cast<int>(std::min(1e6, std::max(1.0, options.minSampleSeconds / perRun)));
+        }
+
+        std::vector<double> samples;
+        std::vector<long long> instructions;
+        std::vector<long long> cycles;
+        for (int i = 0; i < options.repetitions; i++) {
+            long long instructionCount;
+            long long cycleCount;
+            counters.start();
+            auto start = std::chrono::steady_clock::now();
+            for (int b = 0; b < batch; b++) {
+                body();
+            }
+            auto stop = std::chrono::steady_clock::now();
+            if (counters.stop(instructionCount, cycleCount)) {
+                instructions.push_back(instructionCount / batch);
+                cycles.push_back(cycleCount / batch);
+            }
+            samples.push_back(std::chrono::duration<double>(stop - start).count() / batch);
+        }
+
+        Cell cell;
+        cell.algorithm = algorithm;
+        cell.size = size;
+        cell.repetitions = options.repetitions;
+        cell.median = detail::percentile(samples, 0.5);
+        cell.p95 = detail::percentile(samples, 0.95);
+        cell.min = *std::min_element(samples.begin(), samples.end());
+        cell.instructions = detail::medianCount(instructions);
+        cell.cycles = detail::medianCount(cycles);
+        cells.push_back(cell);
+        print(cell);
+        return cells.back();
+    }
+
+    // Writes the baseline, compares against one if requested; returns the process exit code
+    int finish() const {
+        if (!options.saveBaselinePath.empty()) {
+            writeJson(options.saveBaselinePath);
+        }
+        if (options.baselinePath.empty()) {
+            return 0;
+        }
+        return compare(options.baselinePath) == 0 ? 0 : 1;
+    }
+
+private:
+    void print(const Cell& cell) const {
+        std::cout << std::left << std::setw(24) << cell.algorithm << std::setw(10) << cell.size
+                  << " median: " << std::setw(12) << detail::formatSeconds(cell.median)
+                  << " p95: " << std::setw(12) << detail::formatSeconds(cell.p95)
+                  << " min: " << std::setw(12) << detail::formatSeconds(cell.min);
+        if (cell.instructions >= 0) {
+            std::cout << " instructions: " << cell.instructions << " cycles: " << cell.cycles;
+            if (cell.cycles > 0) {
+                std::ostringstream ipc;
+                ipc << std::fixed << std::setprecision(2) << static_cast<double>(cell.instructions) / cell.cycles;
+                std::cout << " IPC: " << ipc.str();
+            }
+        } else {
+            std::cout << " instructions: n/a cycles: n/a";
+        }
+        std::cout << std::right << std::endl;
+    }
+
+    void writeJson(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Failed to write baseline " << path << std::endl;
+            return;
+        }
+        out << "{\n  \"cells\": [\n";
+        out << std::setprecision(9);
+        for (size_t i = 0; i < cells.size(); i++) {
+            const Cell& cell = cells[i];
+            out << "    {\"algorithm\": \"" << cell.algorithm << "\", \"size\": \"" << cell.size
+                << "\", \"repetitions\": " << cell.repetitions << ", \"median\": " << cell.median
+                << ", \"p95\": " << cell.p95 << ", \"min\": " << cell.min
+                << ", \"instructions\": " << cell.instructions << ", \"cycles\": " << cell.cycles << "}";
+            out << (i + 1 < cells.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Returns the number of cells whose median regressed beyond the threshold
+    int compare(const std::string& path) const {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Failed to open baseline " << path << std::endl;
+            return 1;
+        }
+        std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        int regressions = 0;
+        std::cout << "\nComparison with baseline " << path << " (threshold " << options.threshold * 100 << "%)" << std::endl;
+        size_t position = json.find('[');
+        while ((position = json.find('{', position)) != std::string::npos) {
+            size_t close = json.find('}', position);
+            if (close == std::string::npos) {
+                std::cerr << "Skipping unterminated baseline entry at offset " << position << std::endl;
+                break;
+            }
+            std::string object = json.substr(position, close - position + 1);
+            position = close;
+
+            std::string algorithm = detail::field(object, "algorithm");
+            std::string size = detail::field(object, "size");
+            double baseline = 0;
+            if (algorithm.empty() || !detail::parseNumber(detail::field(object, "median"), baseline)) {
+                std::cerr << "Skipping malformed baseline entry: " << object << std::endl;
+                continue;
+            }
+            auto cell = std::find_if(cells.begin(), cells.end(), [&](const Cell& c) {
+                return c.algorithm == algorithm && c.size == size;
+            });
+            if (cell == cells.end()) {
+                continue;
+            }
+            double change = baseline > 0 ? cell->median / baseline - 1 : 0;
+            bool regressed = change > options.threshold;
+            regressions += regressed;
+            std::ostringstream percent;
+            percent << std::showpos << std::fixed << std::setprecision(1) << change * 100 << "%";
+            std::cout << std::left << std::setw(24) << algorithm << std::setw(10) << size << std::right
+                      << " baseline: " << detail::formatSeconds(baseline)
+                      << " now: " << detail::formatSeconds(cell->median)
+                      << " change: " << percent.str() << (regressed ? " REGRESSION" : "") << std::endl;
+        }
+        std::cout << "Regressions: " << regressions << std::endl;
+        return regressions;
+    }
+
+    Options options;
+    PerfCounters counters;
+    std::vector<Cell> cells;
+};
+
+} // namespace benchmark
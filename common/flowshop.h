@@ -0,0 +1,381 @@
+#pragma once
+
+// Permutation flow-shop core shared by lab3 (NEH, QNEH) and lab4 (annealing):
+// instance loading, makespan, head/tail propagation and insertion kernels.
+// Header-only so every lab still builds with a single `g++ main.cpp`.
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "instrumentation.h"
+
+namespace flowshop {
+
+// Read-only view of an instance whose processing times live elsewhere: in an Instance or
+// in a mapped archive (instance_archive.h). The kernels below take views, so both run
+// through the same code without copying; the viewed storage must outlive the view.
+struct InstanceView {
+    int id = 0;
+    int jobCount = 0;
+    int machineCount = 0;
+    int referenceMakespan = 0;
+    const int* times = nullptr; // job-major
+    const int* totalTimes = nullptr;
+
+    const int* job(int j) const {
+        return times + static_cast<size_t>(j) * machineCount;
+    }
+};
+
+// Processing times are stored job-major in one block: times[job * machineCount + machine]
+struct Instance {
+    int id = 0;
+    int jobCount = 0;
+    int machineCount = 0;
+    std::vector<int> times;
+    std::vector<int> totalTimes;
+    int referenceMakespan = 0; // value of the "neh:" section, 0 when the file has none
+
+    const int* job(int j) const {
+        return times.data() + static_cast<size_t>(j) * machineCount;
+    }
+
+    operator InstanceView() const {
+        return {id, jobCount, machineCount, referenceMakespan, times.data(), totalTimes.data()};
+    }
+};
+
+namespace detail {
+
+inline void skipSpace(const char*& cursor, const char* end) {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n')) {
+        cursor++;
+    }
+}
+
+inline bool readInt(const char*& cursor, const char* end, int& value) {
+    skipSpace(cursor, end);
+    if (cursor == end || *cursor < '0' || *cursor > '9') {
+        return false;
+    }
+    value = 0;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + (*cursor - '0');
+        cursor++;
+    }
+    return true;
+}
+
+} // namespace detail
+
+// Parses every "data.XXX:" block of a neh.data.txt-style buffer in a single pass
+inline std::vector<Instance> parseInstances(const char* begin, const char* end) {
+    INSTRUMENT_PHASE(Parse);
+    std::vector<Instance> instances;
+    const char* cursor = begin;
+    static const char dataTag[] = "data.";
+    static const char nehTag[] = "neh:";
+
+    while (true) {
+        const char* tag = std::search(cursor, end, dataTag, dataTag + 5);
+        if (tag == end) {
+            break;
+        }
+        cursor = tag + 5;
+
+        Instance instance;
+        if (!detail::readInt(cursor, end, instance.id) || cursor == end || *cursor != ':') {
+            continue;
+        }
+        cursor++;
+        if (!detail::readInt(cursor, end, instance.jobCount) || !detail::readInt(cursor, end, instance.machineCount)) {
+            break;
+        }
+
+        instance.times.resize(static_cast<size_t>(instance.jobCount) * instance.machineCount);
+        instance.totalTimes.assign(instance.jobCount, 0);
+        bool complete = true;
+        for (int j = 0; j < instance.jobCount && complete; j++) {
+            for (int m = 0; m < instance.machineCount; m++) {
+                int& value = instance.times[static_cast<size_t>(j) * instance.machineCount + m];
+                if (!detail::readInt(cursor, end, value)) {
+                    complete = false;
+                    break;
+                }
+                instance.totalTimes[j] += value;
+            }
+        }
+        if (!complete) {
+            break;
+        }
+
+        detail::skipSpace(cursor, end);
+        if (end - cursor >= 4 && std::memcmp(cursor, nehTag, 4) == 0) {
+            cursor += 4;
+            detail::readInt(cursor, end, instance.referenceMakespan);
+        }
+        instances.push_back(std::move(instance));
+    }
+    return instances;
+}
+
+// Reads the whole file at once; returns no instances when it cannot be opened
+inline std::vector<Instance> loadInstances(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file: " << filePath << std::endl;
+        return {};
+    }
+    std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parseInstances(buffer.data(), buffer.data() + buffer.size());
+}
+
+#if defined(__GNUC__)
+#define FLOWSHOP_UNROLL _Pragma("GCC unroll 32")
+#else
+#define FLOWSHOP_UNROLL
+#endif
+
+// Kernels are templated on the machine count M. Every Taillard family has m = 5, 10 or 20,
+// so those are instantiated with a constant trip count (fully unrolled machine loops,
+// std::array scratch); M = 0 is the generic path that reads instance.machineCount.
+namespace kernels {
+
+template <int M>
+inline int machines(const InstanceView& instance) {
+    return M > 0 ? M : instance.machineCount;
+}
+
+// Advances `row` (completion times on every machine) through `length` jobs of `order`
+template <int M>
+inline void propagateRow(const InstanceView& instance, const int* order, int length, int* row) {
+    const int machineCount = machines<M>(instance);
+    for (int p = 0; p < length; p++) {
+        const int* durations = instance.job(order[p]);
+        int time = 0;
+        FLOWSHOP_UNROLL
+        for (int m = 0; m < machineCount; m++) {
+            time = std::max(time, row[m]) + durations[m];
+            row[m] = time;
+        }
+    }
+}
+
+template <int M>
+inline int makespan(const InstanceView& instance, const int* order, int length) {
+    if (length == 0) {
+        return 0;
+    }
+    if constexpr (M > 0) {
+        std::array<int, M> row{};
+        propagateRow<M>(instance, order, length, row.data());
+        return row[M - 1];
+    } else {
+        std::vector<int> row(instance.machineCount, 0);
+        propagateRow<M>(instance, order, length, row.data());
+        return row[instance.machineCount - 1];
+    }
+}
+
+template <int M>
+inline void computeHeads(const InstanceView& instance, const int* order, int length, int* heads, int from) {
+    const int machineCount = machines<M>(instance);
+    if (from == 0) {
+        std::fill(heads, heads + machineCount, 0);
+    }
+    for (int p = from; p < length; p++) {
+        const int* durations = instance.job(order[p]);
+        const int* previous = heads + static_cast<size_t>(p) * machineCount;
+        int* current = heads + static_cast<size_t>(p + 1) * machineCount;
+        int time = 0;
+        FLOWSHOP_UNROLL
+        for (int m = 0; m < machineCount; m++) {
+            time = std::max(time, previous[m]) + durations[m];
+            current[m] = time;
+        }
+    }
+}
+
+template <int M>
+inline void computeTails(const InstanceView& instance, const int* order, int length, int* tails, int from) {
+    const int machineCount = machines<M>(instance);
+    std::fill(tails + static_cast<size_t>(length) * machineCount, tails + static_cast<size_t>(length + 1) * machineCount, 0);
+    for (int p = from; p >= 0; p--) {
+        const int* durations = instance.job(order[p]);
+        const int* next = tails + static_cast<size_t>(p + 1) * machineCount;
+        int* current = tails + static_cast<size_t>(p) * machineCount;
+        int time = 0;
+        FLOWSHOP_UNROLL
+        for (int m = machineCount - 1; m >= 0; m--) {
+            time = std::max(time, next[m]) + durations[m];
+            current[m] = time;
+        }
+    }
+}
+
+template <int M>
+inline int insertionMakespan(const InstanceView& instance, int job, const int* heads, const int* tails, int pos) {
+    const int machineCount = machines<M>(instance);
+    const int* durations = instance.job(job);
+    const int* head = heads + static_cast<size_t>(pos) * machineCount;
+    const int* tail = tails + static_cast<size_t>(pos) * machineCount;
+    int time = 0;
+    int cmax = 0;
+    FLOWSHOP_UNROLL
+    for (int m = 0; m < machineCount; m++) {
+        time = std::max(time, head[m]) + durations[m];
+        cmax = std::max(cmax, time + tail[m]);
+    }
+    return cmax;
+}
+
+template <int M>
+inline int bestInsertion(const InstanceView& instance, int job, const int* heads, const int* tails, int length, int* bestCmax) {
+    int bestPos = 0;
+    int minCmax = INT_MAX;
+    for (int pos = 0; pos <= length; pos++) {
+        int c = insertionMakespan<M>(instance, job, heads, tails, pos);
+        if (c < minCmax) {
+            minCmax = c;
+            bestPos = pos;
+        }
+    }
+    if (bestCmax != nullptr) {
+        *bestCmax = minCmax;
+    }
+    return bestPos;
+}
+
+} // namespace kernels
+
+// Calls kernel(std::integral_constant<int, M>()) with M fixed for the Taillard machine
+// counts and M = 0 (generic) for everything else
+template <typename Kernel>
+inline decltype(auto) withMachineCount(int machineCount, Kernel&& kernel) {
+    switch (machineCount) {
+    case 5:
+        return kernel(std::integral_constant<int, 5>());
+    case 10:
+        return kernel(std::integral_constant<int, 10>());
+    case 20:
+        return kernel(std::integral_constant<int, 20>());
+    default:
+        return kernel(std::integral_constant<int, 0>());
+    }
+}
+
+// Advances `row` (completion times on every machine) through `length` jobs of `order`
+inline void propagateRow(const InstanceView& instance, const int* order, int length, int* row) {
+    withMachineCount(instance.machineCount, [&](auto M) {
+        kernels::propagateRow<M()>(instance, order, length, row);
+    });
+}
+
+inline int makespan(const InstanceView& instance, const int* order, int length) {
+    INSTRUMENT_COUNT(MakespanEvaluations);
+    return withMachineCount(instance.machineCount, [&](auto M) {
+        return kernels::makespan<M()>(instance, order, length);
+    });
+}
+
+inline int makespan(const InstanceView& instance, const std::vector<int>& order) {
+    return makespan(instance, order.data(), order.size());
+}
+
+// heads has (length + 1) rows of machineCount values: row p + 1 holds the completion
+// times of position p and row 0 is zero. Rows up to `from` must already be valid.
+inline void computeHeads(const InstanceView& instance, const int* order, int length, int* heads, int from = 0) {
+    INSTRUMENT_PHASE(Propagate);
+    withMachineCount(instance.machineCount, [&](auto M) {
+        kernels::computeHeads<M()>(instance, order, length, heads, from);
+    });
+}
+
+// tails has (length + 1) rows: row p holds the time from the start of position p on each
+// machine to the end of the schedule and row length is zero. Rows after `from` must be valid.
+inline void computeTails(const InstanceView& instance, const int* order, int length, int* tails, int from) {
+    INSTRUMENT_PHASE(Propagate);
+    withMachineCount(instance.machineCount, [&](auto M) {
+        kernels::computeTails<M()>(instance, order, length, tails, from);
+    });
+}
+
+inline void computeTails(const InstanceView& instance, const int* order, int length, int* tails) {
+    computeTails(instance, order, length, tails, length - 1);
+}
+
+// Makespan after inserting `job` in front of position `pos`, from the heads/tails of the sequence
+inline int insertionMakespan(const InstanceView& instance, int job, const int* heads, const int* tails, int pos) {
+    return withMachineCount(instance.machineCount, [&](auto M) {
+        return kernels::insertionMakespan<M()>(instance, job, heads, tails, pos);
+    });
+}
+
+// Taillard's acceleration: scores all length + 1 positions in O(length * m), first best wins ties
+inline int bestInsertion(const InstanceView& instance, int job, const int* heads, const int* tails, int length, int* bestCmax = nullptr) {
+    INSTRUMENT_PHASE(Evaluate);
+    INSTRUMENT_ADD(MakespanEvaluations, length + 1);
+    return withMachineCount(instance.machineCount, [&](auto M) {
+        return kernels::bestInsertion<M()>(instance, job, heads, tails, length, bestCmax);
+    });
+}
+
+// Jobs sorted by descending total processing time, ties kept in input order
+inline std::vector<int> getSortedJobOrder(const InstanceView& instance) {
+    INSTRUMENT_PHASE(Sort);
+    std::vector<int> jobOrder(instance.jobCount);
+    std::iota(jobOrder.begin(), jobOrder.end(), 0);
+    std::stable_sort(jobOrder.begin(), jobOrder.end(), [&](int a, int b) {
+        return instance.totalTimes[a] > instance.totalTimes[b];
+    });
+    return jobOrder;
+}
+
+namespace kernels {
+
+template <int M>
+inline std::vector<int> optimizedNEH(const InstanceView& instance, const std::vector<int>& initialOrder) {
+    std::vector<int> finalOrder;
+    finalOrder.reserve(instance.jobCount);
+    std::vector<int> heads(static_cast<size_t>(instance.jobCount + 1) * instance.machineCount, 0);
+    std::vector<int> tails(static_cast<size_t>(instance.jobCount + 1) * instance.machineCount, 0);
+    int bestPos = 0;
+
+    for (int jobIndex : initialOrder) {
+        int currentJobs = finalOrder.size();
+        // heads before the last insertion point are unchanged; tails rows shifted, so rebuild them
+        {
+            INSTRUMENT_PHASE(Propagate);
+            computeHeads<M>(instance, finalOrder.data(), currentJobs, heads.data(), bestPos);
+            computeTails<M>(instance, finalOrder.data(), currentJobs, tails.data(), currentJobs - 1);
+        }
+        {
+            INSTRUMENT_PHASE(Evaluate);
+            INSTRUMENT_ADD(MakespanEvaluations, currentJobs + 1);
+            bestPos = bestInsertion<M>(instance, jobIndex, heads.data(), tails.data(), currentJobs, nullptr);
+        }
+        INSTRUMENT_PHASE(Insert);
+        finalOrder.insert(finalOrder.begin() + bestPos, jobIndex);
+    }
+    return finalOrder;
+}
+
+} // namespace kernels
+
+// NEH with Taillard's acceleration (QNEH)
+inline std::vector<int> optimizedNEH(const InstanceView& instance) {
+    std::vector<int> initialOrder = getSortedJobOrder(instance);
+    return withMachineCount(instance.machineCount, [&](auto M) {
+        return kernels::optimizedNEH<M()>(instance, initialOrder);
+    });
+}
+
+} // namespace flowshop
@@ -0,0 +1,239 @@
+#pragma once
+
+// Indexed binary archive of flow-shop instances, the random-access counterpart of
+// neh.data.txt. writeArchive() converts parsed instances once; Archive maps the file
+// and hands out any instance by index as an InstanceView into the mapping, which the
+// kernels take directly, so nothing is parsed or copied.
+//
+// Layout (little-endian, every block offset a multiple of 32 bytes):
+//   header   32 bytes  "FSARCHV1" | uint32 version | uint32 instance count | 16 reserved
+//   index    32 bytes per instance: uint64 times offset | uint64 totals offset |
+//            int32 id | int32 jobs | int32 machines | int32 reference makespan
+//   blocks   per instance: jobs * machines int32 processing times, job-major exactly as
+//            in Instance::times, then jobs int32 per-job totals, each padded to 32 bytes
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "flowshop.h"
+
+namespace flowshop {
+
+namespace archive {
+
+constexpr char magic[8] = {'F', 'S', 'A', 'R', 'C', 'H', 'V', '1'};
+constexpr uint32_t version = 1;
+constexpr size_t alignment = 32;
+constexpr size_t headerSize = 32;
+
+struct IndexEntry {
+    uint64_t timesOffset;
+    uint64_t totalsOffset;
+    int32_t id;
+    int32_t jobCount;
+    int32_t machineCount;
+    int32_t referenceMakespan;
+};
+static_assert(sizeof(IndexEntry) == 32, "index entries are 32 bytes");
+
+inline size_t alignUp(size_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+} // namespace archive
+
+// Writes `instances` in archive layout; false when the file cannot be written
+inline bool writeArchive(const std::vector<InstanceView>& instances, const std::string& filePath) {
+    std::vector<archive::IndexEntry> index(instances.size());
+    size_t offset = archive::alignUp(archive::headerSize + index.size() * sizeof(archive::IndexEntry));
+    for (size_t i = 0; i < instances.size(); i++) {
+        const InstanceView& instance = instances[i];
+        index[i].id = instance.id;
+        index[i].jobCount = instance.jobCount;
+        index[i].machineCount = instance.machineCount;
+        index[i].referenceMakespan = instance.referenceMakespan;
+        index[i].timesOffset = offset;
+        offset = archive::alignUp(offset + static_cast<size_t>(instance.jobCount) * instance.machineCount * sizeof(int32_t));
+        index[i].totalsOffset = offset;
+        offset = archive::alignUp(offset + static_cast<size_t>(instance.jobCount) * sizeof(int32_t));
+    }
+
+    std::vector<char> image(offset, 0);
+    std::memcpy(image.data(), archive::magic, sizeof(archive::magic));
+    uint32_t count = static_cast<uint32_t>(instances.size());
+    std::memcpy(image.data() + 8, &archive::version, sizeof(uint32_t));
+    std::memcpy(image.data() + 12, &count, sizeof(uint32_t));
+    if (!index.empty()) {
+        std::memcpy(image.data() + archive::headerSize, index.data(), index.size() * sizeof(archive::IndexEntry));
+    }
+    for (size_t i = 0; i < instances.size(); i++) {
+        const InstanceView& instance = instances[i];
+        std::memcpy(image.data() + index[i].timesOffset, instance.times,
+                    static_cast<size_t>(instance.jobCount) * instance.machineCount * sizeof(int32_t));
+        std::memcpy(image.data() + index[i].totalsOffset, instance.totalTimes,
+                    static_cast<size_t>(instance.jobCount) * sizeof(int32_t));
+    }
+
+    FILE* file = std::fopen(filePath.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Error: Cannot write file: " << filePath << std::endl;
+        return false;
+    }
+    bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+    return std::fclose(file) == 0 && written;
+}
+
+class Archive {
+public:
+    Archive() = default;
+
+    ~Archive() {
+        close();
+    }
+
+    Archive(const Archive&) = delete;
+    Archive& operator=(const Archive&) = delete;
+
+    // Maps the file and checks the header and index once, so view() only checks the position
+    bool open(const std::string& filePath) {
+        close();
+        int fd = ::open(filePath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error: Cannot open file: " << filePath << std::endl;
+            return false;
+        }
+        struct stat info;
+        bool opened = ::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= archive::headerSize;
+        if (opened) {
+            size = static_cast<size_t>(info.st_size);
+            void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            opened = mapped != MAP_FAILED;
+            base = opened ? static_cast<const char*>(mapped) : nullptr;
+        }
+        ::close(fd);
+        if (!opened || !validate()) {
+            std::cerr << "Error: Not an instance archive: " << filePath << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base != nullptr) {
+            ::munmap(const_cast<char*>(base), size);
+        }
+        base = nullptr;
+        size = 0;
+        count = 0;
+    }
+
+    int instanceCount() const {
+        return static_cast<int>(count);
+    }
+
+    // The pointers are 32-byte aligned and stay valid while the Archive lives
+    InstanceView view(int position) const {
+        if (position < 0 || position >= instanceCount()) {
+            throw std::out_of_range("archive position " + std::to_string(position) + " of " +
+                                    std::to_string(instanceCount()));
+        }
+        const archive::IndexEntry& entry = indexEntry(position);
+        InstanceView view;
+        view.id = entry.id;
+        view.jobCount = entry.jobCount;
+        view.machineCount = entry.machineCount;
+        view.referenceMakespan = entry.referenceMakespan;
+        view.times = reinterpret_cast<const int*>(base + entry.timesOffset);
+        view.totalTimes = reinterpret_cast<const int*>(base + entry.totalsOffset);
+        return view;
+    }
+
+    // Copies one instance out of the mapping: two memcpys, no parsing
+    Instance instance(int position) const {
+        InstanceView source = view(position);
+        Instance instance;
+        instance.id = source.id;
+        instance.jobCount = source.jobCount;
+        instance.machineCount = source.machineCount;
+        instance.referenceMakespan = source.referenceMakespan;
+        instance.times.assign(source.times, source.times + static_cast<size_t>(source.jobCount) * source.machineCount);
+        instance.totalTimes.assign(source.totalTimes, source.totalTimes + source.jobCount);
+        return instance;
+    }
+
+private:
+    const archive::IndexEntry& indexEntry(int position) const {
+        return reinterpret_cast<const archive::IndexEntry*>(base + archive::headerSize)[position];
+    }
+
+    bool validate() {
+        uint32_t fileVersion;
+        std::memcpy(&fileVersion, base + 8, sizeof(uint32_t));
+        std::memcpy(&count, base + 12, sizeof(uint32_t));
+        if (std::memcmp(base, archive::magic, sizeof(archive::magic)) != 0 || fileVersion != archive::version ||
+            archive::headerSize + static_cast<size_t>(count) * sizeof(archive::IndexEntry) > size) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            const archive::IndexEntry& entry = indexEntry(i);
+            if (entry.jobCount < 0 || entry.machineCount < 0 || entry.timesOffset % archive::alignment != 0 ||
+                entry.totalsOffset % archive::alignment != 0) {
+                return false;
+            }
+            // both products fit in 64 bits; offsets are compared before subtracting so nothing wraps
+            uint64_t timesBytes = static_cast<uint64_t>(entry.jobCount) * entry.machineCount * sizeof(int32_t);
+            uint64_t totalsBytes = static_cast<uint64_t>(entry.jobCount) * sizeof(int32_t);
+            if (entry.timesOffset > size || timesBytes > size - entry.timesOffset || entry.totalsOffset > size ||
+                totalsBytes > size - entry.totalsOffset) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* base = nullptr;
+    size_t size = 0;
+    uint32_t count = 0;
+};
+
+// Views of every instance, valid while `instances` lives
+inline std::vector<InstanceView> viewInstances(const std::vector<Instance>& instances) {
+    return std::vector<InstanceView>(instances.begin(), instances.end());
+}
+
+// Views of every archived instance, valid while `source` stays open
+inline std::vector<InstanceView> viewInstances(const Archive& source) {
+    std::vector<InstanceView> views;
+    views.reserve(source.instanceCount());
+    for (int i = 0; i < source.instanceCount(); i++) {
+        views.push_back(source.view(i));
+    }
+    return views;
+}
+
+// Materialises every archived instance, the archive counterpart of loadInstances(); the
+// labs use viewInstances() and keep this as the copying baseline of the loading benchmark
+inline std::vector<Instance> loadArchive(const std::string& filePath) {
+    Archive source;
+    std::vector<Instance> instances;
+    if (!source.open(filePath)) {
+        return instances;
+    }
+    instances.reserve(source.instanceCount());
+    for (int i = 0; i < source.instanceCount(); i++) {
+        instances.push_back(source.instance(i));
+    }
+    return instances;
+}
+
+} // namespace flowshop
@@ -0,0 +1,193 @@
+#pragma once
+
+// Hot-path instrumentation for the scheduling engines: per-phase scoped timers and
+// event counters kept in thread-local blocks and summed on demand. Everything is
+// compiled out unless the build defines INSTRUMENTATION, e.g.
+//   g++ -O2 -DINSTRUMENTATION main.cpp
+//
+// Engines mark work with INSTRUMENT_PHASE(Propagate) / INSTRUMENT_COUNT(MovesAccepted);
+// the labs print INSTRUMENT_REPORT(out, label) as one JSON line next to each instance's
+// result and INSTRUMENT_SUMMARY(out) as a table at the end. A report folds every
+// thread's block into the run totals and clears it, so call it while workers are idle.
+
+#if defined(INSTRUMENTATION)
+
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace instrumentation {
+
+enum Phase { Parse, Sort, Propagate, Evaluate, Insert, PhaseCount };
+
+enum Counter { MakespanEvaluations, MovesAccepted, MovesRejected, StatesExpanded, HeapOperations, CounterCount };
+
+inline const char* phaseName(int phase) {
+    static const char* names[PhaseCount] = {"parse", "sort", "propagate", "evaluate", "insert"};
+    return names[phase];
+}
+
+inline const char* counterName(int counter) {
+    static const char* names[CounterCount] = {"makespan_evaluations", "moves_accepted", "moves_rejected",
+                                              "dp_states_expanded", "heap_operations"};
+    return names[counter];
+}
+
+struct Totals {
+    long long phaseCalls[PhaseCount] = {};
+    long long phaseNanoseconds[PhaseCount] = {};
+    long long counters[CounterCount] = {};
+
+    void add(const Totals& other) {
+        for (int p = 0; p < PhaseCount; p++) {
+            phaseCalls[p] += other.phaseCalls[p];
+            phaseNanoseconds[p] += other.phaseNanoseconds[p];
+        }
+        for (int c = 0; c < CounterCount; c++) {
+            counters[c] += other.counters[c];
+        }
+    }
+};
+
+// Blocks of live threads plus whatever exited threads left behind
+class Registry {
+public:
+    void attach(Totals* totals) {
+        std::lock_guard<std::mutex> lock(mutex);
+        live.push_back(totals);
+    }
+
+    void detach(Totals* totals) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.add(*totals);
+        for (size_t i = 0; i < live.size(); i++) {
+            if (live[i] == totals) {
+                live[i] = live.back();
+                live.pop_back();
+                break;
+            }
+        }
+    }
+
+    // Sums and clears all blocks; the result is also added to the run totals
+    Totals drain() {
+        std::lock_guard<std::mutex> lock(mutex);
+        Totals drained = pending;
+        pending = Totals();
+        for (Totals* totals : live) {
+            drained.add(*totals);
+            *totals = Totals();
+        }
+        run.add(drained);
+        return drained;
+    }
+
+    Totals runTotals() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return run;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<Totals*> live;
+    Totals pending;
+    Totals run;
+};
+
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+struct ThreadSlot {
+    Totals totals;
+
+    ThreadSlot() {
+        registry().attach(&totals);
+    }
+
+    ~ThreadSlot() {
+        registry().detach(&totals);
+    }
+};
+
+inline Totals& local() {
+    thread_local ThreadSlot slot;
+    return slot.totals;
+}
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Phase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        Totals& totals = local();
+        totals.phaseCalls[phase]++;
+        totals.phaseNanoseconds[phase] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+inline void writeJson(std::ostream& out, const std::string& label, const Totals& totals) {
+    out << "instrumentation {\"instance\": \"" << label << "\", \"phases\": {";
+    for (int p = 0; p < PhaseCount; p++) {
+        out << (p ? ", " : "") << "\"" << phaseName(p) << "\": {\"calls\": " << totals.phaseCalls[p]
+            << ", \"ms\": " << totals.phaseNanoseconds[p] / 1e6 << "}";
+    }
+    out << "}, \"counters\": {";
+    for (int c = 0; c < CounterCount; c++) {
+        out << (c ? ", " : "") << "\"" << counterName(c) << "\": " << totals.counters[c];
+    }
+    out << "}}" << std::endl;
+}
+
+inline void report(std::ostream& out, const std::string& label) {
+    writeJson(out, label, registry().drain());
+}
+
+inline void summary(std::ostream& out) {
+    registry().drain();
+    Totals totals = registry().runTotals();
+    out << "\nInstrumentation summary" << std::endl;
+    out << std::left << std::setw(24) << "phase" << std::right << std::setw(14) << "calls" << std::setw(14) << "total ms"
+        << std::setw(14) << "ns/call" << std::endl;
+    for (int p = 0; p < PhaseCount; p++) {
+        long long calls = totals.phaseCalls[p];
+        out << std::left << std::setw(24) << phaseName(p) << std::right << std::setw(14) << calls << std::setw(14)
+            << totals.phaseNanoseconds[p] / 1000000 << std::setw(14) << (calls ? totals.phaseNanoseconds[p] / calls : 0)
+            << std::endl;
+    }
+    out << std::left << std::setw(24) << "counter" << std::right << std::setw(14) << "events" << std::endl;
+    for (int c = 0; c < CounterCount; c++) {
+        out << std::left << std::setw(24) << counterName(c) << std::right << std::setw(14) << totals.counters[c]
+            << std::endl;
+    }
+}
+
+} // namespace instrumentation
+
+#define INSTRUMENT_CONCAT_INNER(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_INNER(a, b)
+#define INSTRUMENT_PHASE(phase) \
+    instrumentation::ScopedTimer INSTRUMENT_CONCAT(instrumentationTimer, __LINE__)(instrumentation::phase)
+#define INSTRUMENT_COUNT(counter) (instrumentation::local().counters[instrumentation::counter]++)
+#define INSTRUMENT_ADD(counter, amount) (instrumentation::local().counters[instrumentation::counter] += (amount))
+#define INSTRUMENT_REPORT(out, label) instrumentation::report(out, label)
+#define INSTRUMENT_SUMMARY(out) instrumentation::summary(out)
+
+#else
+
+#define INSTRUMENT_PHASE(phase) ((void)0)
+#define INSTRUMENT_COUNT(counter) ((void)0)
+#define INSTRUMENT_ADD(counter, amount) ((void)0)
+#define INSTRUMENT_REPORT(out, label) ((void)0)
+#define INSTRUMENT_SUMMARY(out) ((void)0)
+
+#endif
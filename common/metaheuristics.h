@@ -0,0 +1,282 @@
+#pragma once
+
+// Simulated annealing, iterated local search and tabu search over permutation problems,
+// written once and instantiated per problem type: every call into the problem is
+// resolved at compile time, so the inner loops carry no virtual dispatch.
+//
+// A Problem is any type providing
+//   int size() const                           number of positions in the permutation
+//   long long cost() const                     objective of the current permutation
+//   long long delta(const Move& move)          cost change `move` would make; state unchanged
+//   void apply(const Move& move)
+//   void undo(const Move& move)                reverts the apply(move) just made
+//   const std::vector<int>& order() const
+//   void assign(const std::vector<int>& order) replaces the permutation
+// with Move, drawMove and insertionMove from moves.h. A Problem that can score the whole
+// insertion neighbourhood faster than one delta() per move may also provide
+//   template <typename Admissible> Insertion bestInsertion(const Admissible& admissible)
+// returning the insertionMove(from, to) of least cost change among those for which
+// admissible(from, to, change) holds, scanned like detail::bestInsertion below; tabuSearch
+// then uses it in place of the delta() scan. Adapters for RPQ, WiTi and the flow shop live
+// in problems.h. The randomised searches draw from the caller's engine.
+
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.h"
+#include "moves.h"
+
+namespace meta {
+
+template <typename Problem>
+constexpr void requireProblem() {
+    static_assert(std::is_convertible<decltype(std::declval<const Problem&>().size()), int>::value,
+                  "Problem::size() must return the permutation length");
+    static_assert(std::is_convertible<decltype(std::declval<const Problem&>().cost()), long long>::value,
+                  "Problem::cost() must return the objective");
+    static_assert(std::is_convertible<decltype(std::declval<Problem&>().delta(std::declval<const Move&>())), long long>::value,
+                  "Problem::delta(move) must return the cost change");
+    static_assert(std::is_void<decltype(std::declval<Problem&>().apply(std::declval<const Move&>()))>::value &&
+                      std::is_void<decltype(std::declval<Problem&>().undo(std::declval<const Move&>()))>::value,
+                  "Problem must provide apply(move) and undo(move)");
+    static_assert(std::is_same<decltype(std::declval<const Problem&>().order()), const std::vector<int>&>::value,
+                  "Problem::order() must return the permutation");
+}
+
+struct Result {
+    std::vector<int> order;
+    long long cost = 0;
+    long long evaluations = 0; // moves scored, by delta() or a problem's bestInsertion
+    double seconds = 0;
+    std::vector<std::pair<double, long long>> improvements; // (seconds, best cost), starting with the initial cost
+};
+
+struct AnnealingSettings {
+    long long iterations = 100000;
+    double initialTemperature = 100.0; // problem-specific; the flow shop calibrates them in annealing.h
+    double finalTemperature = 1.0;
+    MoveMix mix = {0.2, 0.6, 0.2, 4};
+    std::ostream* trace = nullptr; // "iteration, current cost" every 100 iterations when set
+};
+
+struct LocalSearchSettings {
+    long long evaluations = 100000; // total delta() budget
+    int stallLimit = 500;           // non-improving moves that end a descent
+    int perturbationMoves = 4;      // random moves applied to the best order between descents
+    MoveMix mix = {0.5, 0.5, 0.0, 4};
+};
+
+struct TabuSettings {
+    long long iterations = 100;
+    int tenure = 8;
+    double timeLimitSeconds = 0; // stops earlier once exceeded; 0 for no limit
+};
+
+// A move of the insertion neighbourhood with its cost change; from is -1 when there is none
+struct Insertion {
+    int from = -1;
+    int to = -1;
+    long long change = 0;
+};
+
+namespace detail {
+
+class Stopwatch {
+public:
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+
+template <typename Problem>
+Result initialResult(const Problem& problem) {
+    Result result;
+    result.order = problem.order();
+    result.cost = problem.cost();
+    result.improvements.push_back({0.0, result.cost});
+    return result;
+}
+
+// The (n - 1)^2 distinct insertions in from-major order, skipping to == from and
+// to == from - 1 (moving to the neighbour on the left equals moving that neighbour right);
+// the first of least change wins ties
+template <typename Problem, typename Admissible>
+Insertion bestInsertion(Problem& problem, const Admissible& admissible) {
+    const int n = problem.size();
+    Insertion best;
+    for (int from = 0; from < n; from++) {
+        for (int to = 0; to < n; to++) {
+            if (to == from || to == from - 1) {
+                continue;
+            }
+            long long change = problem.delta(insertionMove(from, to));
+            if (admissible(from, to, change) && (best.from < 0 || change < best.change)) {
+                best = {from, to, change};
+            }
+        }
+    }
+    return best;
+}
+
+template <typename Problem, typename = void>
+struct HasBestInsertion : std::false_type {};
+
+template <typename Problem>
+struct HasBestInsertion<Problem, std::void_t<decltype(std::declval<Problem&>().bestInsertion(
+                                     std::declval<bool (*)(int, int, long long)>()))>> : std::true_type {};
+
+template <typename Problem>
+void recordBest(Result& best, const Problem& problem, long long cost, const Stopwatch& clock) {
+    if (cost < best.cost) {
+        best.improvements.push_back({clock.seconds(), cost});
+    }
+    best.cost = cost;
+    best.order = problem.order();
+}
+
+} // namespace detail
+
+// Metropolis acceptance under geometric cooling from the initial to the final temperature;
+// the problem is left holding the best permutation found
+template <typename Problem>
+Result anneal(Problem& problem, const AnnealingSettings& settings, Random& random) {
+    requireProblem<Problem>();
+    detail::Stopwatch clock;
+    Result best = detail::initialResult(problem);
+    if (problem.size() < 2) {
+        return best;
+    }
+    long long current = best.cost;
+    double temperature = settings.initialTemperature;
+    double cooling = std::pow(settings.finalTemperature / settings.initialTemperature, 1.0 / settings.iterations);
+
+    for (long long i = 0; i < settings.iterations; i++) {
+        Move move = drawMove(problem.size(), settings.mix, random);
+        long long change = problem.delta(move);
+        if (change <= 0 || randomUnit(random) < std::exp(-change / temperature)) {
+            INSTRUMENT_COUNT(MovesAccepted);
+            problem.apply(move);
+            current += change;
+            if (current < best.cost) {
+                detail::recordBest(best, problem, current, clock);
+            }
+        } else {
+            INSTRUMENT_COUNT(MovesRejected);
+        }
+        if (settings.trace != nullptr && i % 100 == 0) {
+            *settings.trace << i << ", " << current << "\n";
+        }
+        temperature *= cooling;
+    }
+    problem.assign(best.order);
+    best.evaluations = settings.iterations;
+    best.seconds = clock.seconds();
+    return best;
+}
+
+// Random first-improvement descents, each ended by `stallLimit` consecutive non-improving
+// moves and followed by a perturbation of the best permutation (better-or-equal acceptance)
+template <typename Problem>
+Result iteratedLocalSearch(Problem& problem, const LocalSearchSettings& settings, Random& random) {
+    requireProblem<Problem>();
+    detail::Stopwatch clock;
+    Result best = detail::initialResult(problem);
+    if (problem.size() < 2) {
+        return best;
+    }
+    long long current = best.cost;
+    long long evaluations = 0;
+    while (evaluations < settings.evaluations) {
+        int stall = 0;
+        while (stall < settings.stallLimit && evaluations < settings.evaluations) {
+            Move move = drawMove(problem.size(), settings.mix, random);
+            long long change = problem.delta(move);
+            evaluations++;
+            if (change < 0) {
+                INSTRUMENT_COUNT(MovesAccepted);
+                problem.apply(move);
+                current += change;
+                stall = 0;
+            } else {
+                INSTRUMENT_COUNT(MovesRejected);
+                stall++;
+            }
+        }
+        if (current <= best.cost) {
+            detail::recordBest(best, problem, current, clock);
+        } else {
+            problem.assign(best.order);
+            current = best.cost;
+        }
+        for (int k = 0; k < settings.perturbationMoves; k++) {
+            Move move = drawMove(problem.size(), settings.mix, random);
+            current += problem.delta(move);
+            evaluations++;
+            problem.apply(move);
+        }
+    }
+    if (current < best.cost) {
+        detail::recordBest(best, problem, current, clock);
+    }
+    problem.assign(best.order);
+    best.evaluations = evaluations;
+    best.seconds = clock.seconds();
+    return best;
+}
+
+// Best admissible move of the whole insertion neighbourhood per iteration, from the
+// problem's own bestInsertion when it has one. After moving the element at position p,
+// putting that element back at p is tabu for `tenure` iterations; a tabu move is still
+// taken when it beats the best cost (aspiration).
+template <typename Problem>
+Result tabuSearch(Problem& problem, const TabuSettings& settings) {
+    requireProblem<Problem>();
+    detail::Stopwatch clock;
+    const int n = problem.size();
+    Result best = detail::initialResult(problem);
+    if (n < 2) {
+        return best;
+    }
+    long long current = best.cost;
+    std::vector<long long> tabuUntil(static_cast<size_t>(n) * n, 0);
+
+    for (long long iteration = 1; iteration <= settings.iterations; iteration++) {
+        if (settings.timeLimitSeconds > 0 && clock.seconds() > settings.timeLimitSeconds) {
+            break;
+        }
+        const std::vector<int>& order = problem.order();
+        auto admissible = [&](int from, int to, long long change) {
+            bool tabu = tabuUntil[static_cast<size_t>(order[from]) * n + to] >= iteration;
+            return !tabu || current + change < best.cost;
+        };
+        Insertion move;
+        if constexpr (detail::HasBestInsertion<Problem>::value) {
+            move = problem.bestInsertion(admissible);
+        } else {
+            move = detail::bestInsertion(problem, admissible);
+        }
+        best.evaluations += static_cast<long long>(n - 1) * (n - 1);
+        if (move.from < 0) {
+            continue; // the whole neighbourhood is tabu; let tenures expire
+        }
+        INSTRUMENT_COUNT(MovesAccepted);
+        tabuUntil[static_cast<size_t>(order[move.from]) * n + move.from] = iteration + settings.tenure;
+        problem.apply(insertionMove(move.from, move.to));
+        current += move.change;
+        if (current < best.cost) {
+            detail::recordBest(best, problem, current, clock);
+        }
+    }
+    problem.assign(best.order);
+    best.seconds = clock.seconds();
+    return best;
+}
+
+} // namespace meta
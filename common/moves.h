@@ -0,0 +1,105 @@
+#pragma once
+
+// Neighbourhood moves on a permutation: swaps, single-element insertions and block
+// moves, each confined to a window of positions so that evaluators can rescore only the
+// window. Used by the generic metaheuristics and the flow-shop IncrementalEvaluator.
+// Moves are drawn from an engine the caller owns, so concurrent searches neither share
+// nor contend on a random stream and a seed reproduces a run.
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using Random = std::mt19937;
+
+// Uniform in [0, bound)
+inline int randomBelow(Random& random, int bound) {
+    return static_cast<int>(random() % static_cast<unsigned>(bound));
+}
+
+// Uniform in [0, 1)
+inline double randomUnit(Random& random) {
+    return random() / (static_cast<double>(Random::max()) + 1.0);
+}
+
+enum class MoveType { Swap, Insert, Block };
+
+// Relative weights of the neighbourhoods drawMove picks from
+struct MoveMix {
+    double swapWeight = 1.0;
+    double insertWeight = 0.0;
+    double blockWeight = 0.0;
+    int maxBlockLength = 4;
+};
+
+// A move touches only positions [first, last]; the window is rotated by `shift`
+// (block moves and insertions) or has its ends exchanged (swaps)
+struct Move {
+    MoveType type;
+    int first;
+    int last;
+    int shift;
+};
+
+inline Move drawMove(int unitCount, const MoveMix& mix, Random& random) {
+    double total = mix.swapWeight + mix.insertWeight + mix.blockWeight;
+    double pick = randomUnit(random) * total;
+    MoveType type = MoveType::Swap;
+    if (pick >= mix.swapWeight + mix.insertWeight && mix.blockWeight > 0) {
+        type = MoveType::Block;
+    } else if (pick >= mix.swapWeight && mix.insertWeight > 0) {
+        type = MoveType::Insert;
+    }
+
+    int maxLength = std::min(mix.maxBlockLength, unitCount - 1);
+    if (type == MoveType::Block && maxLength < 2) {
+        type = MoveType::Insert;
+    }
+
+    if (type == MoveType::Swap) {
+        int firstPosition = randomBelow(random, unitCount);
+        int secondPosition;
+        do {
+            secondPosition = randomBelow(random, unitCount);
+        } while (firstPosition == secondPosition);
+        return {type, std::min(firstPosition, secondPosition), std::max(firstPosition, secondPosition), 0};
+    }
+
+    int length = type == MoveType::Block ? 2 + randomBelow(random, maxLength - 1) : 1;
+    int from = randomBelow(random, unitCount - length + 1);
+    int to;
+    do {
+        to = randomBelow(random, unitCount - length + 1);
+    } while (to == from);
+    if (to < from) {
+        // block lands earlier: rotate it to the front of [to, from + length)
+        return {type, to, from + length - 1, from - to};
+    }
+    // block lands later: everything after it in [from, to + length) moves forward
+    return {type, from, to + length - 1, length};
+}
+
+inline void applyMove(std::vector<int>& sequence, const Move& move) {
+    if (move.type == MoveType::Swap) {
+        std::swap(sequence[move.first], sequence[move.last]);
+    } else {
+        std::rotate(sequence.begin() + move.first, sequence.begin() + move.first + move.shift, sequence.begin() + move.last + 1);
+    }
+}
+
+// The move that restores the sequence `move` produced
+inline Move inverseMove(const Move& move) {
+    if (move.type == MoveType::Swap) {
+        return move;
+    }
+    return {move.type, move.first, move.last, move.last - move.first + 1 - move.shift};
+}
+
+// Insertion that takes the element at `from` to position `to`
+inline Move insertionMove(int from, int to) {
+    if (to < from) {
+        return {MoveType::Insert, to, from, from - to};
+    }
+    return {MoveType::Insert, from, to, 1};
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+// Problem adapters for the generic metaheuristics (metaheuristics.h). Each keeps enough
+// per-position state of its permutation that delta() rescores only the window a move
+// touches, plus whatever follows it until the schedule falls back in step:
+//  - RpqProblem (lab1, 1|r_j,q_j|Cmax): completion times and prefix/suffix maxima of
+//    completion + delivery
+//  - WitiProblem (lab2, 1||sum w_j T_j): completion times and per-position penalties;
+//    a move never changes completion times outside its window
+//  - FlowShopProblem (lab3/lab4, F|prmu|Cmax): the head/tail IncrementalEvaluator, whose
+//    insertion scan also gives tabu search the whole neighbourhood in O(n^2 * m)
+// Permutations hold 0-based indices into the task arrays.
+
+#include <algorithm>
+#include <vector>
+
+#include "annealing.h"
+#include "flowshop.h"
+#include "moves.h"
+#include "rpq.h"
+#include "witi.h"
+
+namespace meta {
+
+namespace detail {
+
+// Writes the elements of `order` in [move.first, move.last] after `move` into `window`
+inline void movedWindow(const std::vector<int>& order, const Move& move, std::vector<int>& window) {
+    int length = move.last - move.first + 1;
+    std::copy(order.begin() + move.first, order.begin() + move.last + 1, window.begin());
+    if (move.type == MoveType::Swap) {
+        std::swap(window[0], window[length - 1]);
+    } else {
+        std::rotate(window.begin(), window.begin() + move.shift, window.begin() + length);
+    }
+}
+
+} // namespace detail
+
+class RpqProblem {
+public:
+    RpqProblem(const rpq::Task* tasks, int count, const std::vector<int>& initialOrder)
+        : tasks(tasks, tasks + count), sequence(initialOrder), finish(count), prefixMax(count), suffixMax(count + 1, 0),
+          window(count) {
+        rebuild(0);
+    }
+
+    int size() const {
+        return static_cast<int>(sequence.size());
+    }
+
+    long long cost() const {
+        return sequence.empty() ? 0 : prefixMax.back();
+    }
+
+    long long delta(const Move& move) {
+        detail::movedWindow(sequence, move, window);
+        long long time = move.first > 0 ? finish[move.first - 1] : 0;
+        long long cmax = move.first > 0 ? prefixMax[move.first - 1] : 0;
+        int length = move.last - move.first + 1;
+        for (int i = 0; i < length; i++) {
+            const rpq::Task& task = tasks[window[i]];
+            time = std::max<long long>(time, task.preparationTime) + task.executionTime;
+            cmax = std::max(cmax, time + task.deliveryTime);
+        }
+        // once the machine frees up at the old time again, the rest of the schedule is unchanged
+        int p = move.last;
+        while (p + 1 < size() && time != finish[p]) {
+            const rpq::Task& task = tasks[sequence[++p]];
+            time = std::max<long long>(time, task.preparationTime) + task.executionTime;
+            cmax = std::max(cmax, time + task.deliveryTime);
+        }
+        return std::max(cmax, suffixMax[p + 1]) - cost();
+    }
+
+    void apply(const Move& move) {
+        applyMove(sequence, move);
+        rebuild(move.first);
+    }
+
+    void undo(const Move& move) {
+        apply(inverseMove(move));
+    }
+
+    const std::vector<int>& order() const {
+        return sequence;
+    }
+
+    void assign(const std::vector<int>& newOrder) {
+        sequence = newOrder;
+        rebuild(0);
+    }
+
+private:
+    void rebuild(int from) {
+        long long time = from > 0 ? finish[from - 1] : 0;
+        long long cmax = from > 0 ? prefixMax[from - 1] : 0;
+        for (int p = from; p < size(); p++) {
+            const rpq::Task& task = tasks[sequence[p]];
+            time = std::max<long long>(time, task.preparationTime) + task.executionTime;
+            finish[p] = time;
+            cmax = std::max(cmax, time + task.deliveryTime);
+            prefixMax[p] = cmax;
+        }
+        for (int p = size() - 1; p >= 0; p--) {
+            suffixMax[p] = std::max(suffixMax[p + 1], finish[p] + tasks[sequence[p]].deliveryTime);
+        }
+    }
+
+    std::vector<rpq::Task> tasks;
+    std::vector<int> sequence;
+    std::vector<long long> finish;    // machine completion after position p
+    std::vector<long long> prefixMax; // max completion + delivery over positions <= p
+    std::vector<long long> suffixMax; // the same over positions >= p
+    std::vector<int> window;
+};
+
+class WitiProblem {
+public:
+    WitiProblem(const witi::Task* tasks, int count, const std::vector<int>& initialOrder)
+        : tasks(tasks, tasks + count), sequence(initialOrder), finish(count), penalty(count), window(count) {
+        total = 0;
+        rescore(0, count - 1);
+    }
+
+    int size() const {
+        return static_cast<int>(sequence.size());
+    }
+
+    long long cost() const {
+        return total;
+    }
+
+    long long delta(const Move& move) {
+        detail::movedWindow(sequence, move, window);
+        long long time = move.first > 0 ? finish[move.first - 1] : 0;
+        long long change = 0;
+        for (int p = move.first; p <= move.last; p++) {
+            const witi::Task& task = tasks[window[p - move.first]];
+            time += task.executionTime;
+            change += std::max<long long>(0, time - task.completionTime) * task.penaltyWeight - penalty[p];
+        }
+        return change;
+    }
+
+    void apply(const Move& move) {
+        applyMove(sequence, move);
+        rescore(move.first, move.last);
+    }
+
+    void undo(const Move& move) {
+        apply(inverseMove(move));
+    }
+
+    const std::vector<int>& order() const {
+        return sequence;
+    }
+
+    void assign(const std::vector<int>& newOrder) {
+        sequence = newOrder;
+        rescore(0, size() - 1);
+    }
+
+private:
+    void rescore(int first, int last) {
+        long long time = first > 0 ? finish[first - 1] : 0;
+        for (int p = first; p <= last; p++) {
+            const witi::Task& task = tasks[sequence[p]];
+            time += task.executionTime;
+            finish[p] = time;
+            total -= penalty[p];
+            penalty[p] = std::max<long long>(0, time - task.completionTime) * task.penaltyWeight;
+            total += penalty[p];
+        }
+    }
+
+    std::vector<witi::Task> tasks;
+    std::vector<int> sequence;
+    std::vector<long long> finish;
+    std::vector<long long> penalty;
+    std::vector<int> window;
+    long long total;
+};
+
+class FlowShopProblem {
+public:
+    FlowShopProblem(const flowshop::InstanceView& instance, const std::vector<int>& initialOrder)
+        : evaluator(instance, initialOrder) {}
+
+    int size() const {
+        return static_cast<int>(evaluator.currentSequence().size());
+    }
+
+    long long cost() const {
+        return evaluator.makespan();
+    }
+
+    long long delta(const Move& move) {
+        return evaluator.evaluate(move) - evaluator.makespan();
+    }
+
+    void apply(const Move& move) {
+        evaluator.accept(move);
+    }
+
+    void undo(const Move& move) {
+        evaluator.accept(inverseMove(move));
+    }
+
+    const std::vector<int>& order() const {
+        return evaluator.currentSequence();
+    }
+
+    void assign(const std::vector<int>& newOrder) {
+        evaluator.reset(newOrder);
+    }
+
+    template <typename Admissible>
+    Insertion bestInsertion(const Admissible& admissible) {
+        long long cmax = cost();
+        Insertion best;
+        evaluator.scanInsertions([&](int from, int to, int makespan) {
+            long long change = makespan - cmax;
+            if (admissible(from, to, change) && (best.from < 0 || change < best.change)) {
+                best = {from, to, change};
+            }
+        });
+        return best;
+    }
+
+private:
+    IncrementalEvaluator evaluator;
+};
+
+} // namespace meta
@@ -0,0 +1,302 @@
+#pragma once
+
+// Content-addressed cache of solved instances. A result is keyed by a 128-bit digest of
+// the canonical instance (sizes and processing data as integers, independent of how the
+// text was laid out) together with the algorithm and its parameters, so resubmitting the
+// same instance returns the stored objective and sequence without solving again. The
+// digest only locates an entry: each entry also keeps a Fingerprint (the sizes, the
+// parameters and a second, independently computed hash of the data) and a hit is served
+// only when that matches too, so a digest collision costs a solve, not a wrong answer.
+//
+// Entries live in memory under LRU eviction. save() writes them, oldest first, to a flat
+// file that load() maps read-only at start-up:
+//   "RESCACHE" | uint32 version | uint32 entry count
+//   per entry: uint64 digest high, uint64 digest low, uint32 rows, uint32 columns,
+//              uint64 parameters, uint64 check, int64 objective, uint32 sequence bytes,
+//              sequence text
+// All integers are little-endian host order; a file written by another version is ignored.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cache {
+
+struct Digest {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    bool operator==(const Digest& other) const {
+        return high == other.high && low == other.low;
+    }
+};
+
+struct DigestHash {
+    size_t operator()(const Digest& digest) const {
+        return static_cast<size_t>(digest.low);
+    }
+};
+
+// Two independent multiply-rotate lanes over 64-bit words, finished with the
+// splitmix64 avalanche; a few cycles per word, far below the cost of parsing
+class Hasher {
+public:
+    void add(uint64_t word) {
+        a = rotate((a ^ word) * 0x9e3779b97f4a7c15ULL, 29);
+        b = rotate((b + word) * 0xc2b2ae3d27d4eb4fULL, 31) ^ a;
+        words++;
+    }
+
+    void add(const int* values, size_t count) {
+        size_t i = 0;
+        for (; i + 1 < count; i += 2) {
+            add(static_cast<uint32_t>(values[i]) | static_cast<uint64_t>(static_cast<uint32_t>(values[i + 1])) << 32);
+        }
+        if (i < count) {
+            add(static_cast<uint32_t>(values[i]));
+        }
+    }
+
+    Digest finish() const {
+        return {mix(a ^ words), mix(b + (words << 1))};
+    }
+
+private:
+    static uint64_t rotate(uint64_t value, int bits) {
+        return value << bits | value >> (64 - bits);
+    }
+
+    static uint64_t mix(uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    uint64_t a = 0x243f6a8885a308d3ULL;
+    uint64_t b = 0x13198a2e03707344ULL;
+    uint64_t words = 0;
+};
+
+// Polynomial hash of the values modulo the Mersenne prime 2^61 - 1; shares nothing with
+// Hasher, so a Hasher collision is not also a Checksum collision
+class Checksum {
+public:
+    void add(const int* values, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            value = reduce(static_cast<unsigned __int128>(value) * base + static_cast<uint32_t>(values[i]) + 1);
+        }
+    }
+
+    uint64_t finish() const {
+        return value;
+    }
+
+private:
+    static constexpr uint64_t prime = (1ULL << 61) - 1;
+    static constexpr uint64_t base = 0x1fc5c2a2a3b1e6dbULL % prime;
+
+    static uint64_t reduce(unsigned __int128 value) {
+        uint64_t folded = static_cast<uint64_t>(value & prime) + static_cast<uint64_t>(value >> 61);
+        folded = (folded & prime) + (folded >> 61);
+        return folded >= prime ? folded - prime : folded;
+    }
+
+    uint64_t value = 0;
+};
+
+// Checked against the stored entry on every digest match
+struct Fingerprint {
+    uint32_t rows = 0;
+    uint32_t columns = 0;
+    uint64_t parameters = 0; // the algorithm and its settings, packed by the caller
+    uint64_t check = 0;      // Checksum of the data
+
+    bool operator==(const Fingerprint& other) const {
+        return rows == other.rows && columns == other.columns && parameters == other.parameters && check == other.check;
+    }
+};
+
+struct Result {
+    long long objective = 0;
+    std::string sequence;
+};
+
+struct Counters {
+    long long hits = 0;
+    long long misses = 0;
+    long long collisions = 0; // digest matches rejected by the fingerprint, counted as misses too
+    long long evictions = 0;
+    long long entries = 0;
+};
+
+class ResultCache {
+public:
+    explicit ResultCache(size_t capacity) : capacity(capacity) {}
+
+    bool find(const Digest& key, const Fingerprint& fingerprint, Result& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(key);
+        if (found == index.end() || !(found->second->fingerprint == fingerprint)) {
+            collisions += found != index.end();
+            misses++;
+            return false;
+        }
+        entries.splice(entries.begin(), entries, found->second);
+        result = found->second->result;
+        hits++;
+        return true;
+    }
+
+    // Replaces any entry under the same digest, colliding or not
+    void insert(const Digest& key, const Fingerprint& fingerprint, Result result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        insertLocked(key, fingerprint, std::move(result));
+    }
+
+    Counters counters() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return {hits, misses, collisions, evictions, static_cast<long long>(entries.size())};
+    }
+
+    // Writes every entry to `path` through a temporary file and a rename
+    bool save(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string temporary = path + ".tmp";
+        FILE* file = std::fopen(temporary.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        uint32_t count = static_cast<uint32_t>(entries.size());
+        bool written = std::fwrite(magic, 1, 8, file) == 8 && put(file, version) && put(file, count);
+        for (auto entry = entries.rbegin(); written && entry != entries.rend(); ++entry) {
+            const Fingerprint& fingerprint = entry->fingerprint;
+            const Result& result = entry->result;
+            uint32_t length = static_cast<uint32_t>(result.sequence.size());
+            written = put(file, entry->key.high) && put(file, entry->key.low) && put(file, fingerprint.rows) &&
+                      put(file, fingerprint.columns) && put(file, fingerprint.parameters) && put(file, fingerprint.check) &&
+                      put(file, static_cast<int64_t>(result.objective)) && put(file, length) &&
+                      std::fwrite(result.sequence.data(), 1, length, file) == length;
+        }
+        written = std::fclose(file) == 0 && written;
+        if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Maps a file written by save() and inserts its entries; returns how many were read
+    long long load(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return 0;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < 16) {
+            ::close(fd);
+            return 0;
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            return 0;
+        }
+
+        const char* cursor = static_cast<const char*>(mapped);
+        const char* end = cursor + size;
+        long long loaded = 0;
+        uint32_t fileVersion = get<uint32_t>(cursor + 8);
+        uint32_t count = get<uint32_t>(cursor + 12);
+        if (std::memcmp(cursor, magic, 8) == 0 && fileVersion == version) {
+            cursor += 16;
+            std::lock_guard<std::mutex> lock(mutex);
+            for (uint32_t i = 0; i < count && end - cursor >= entryHeaderSize; i++) {
+                Digest key = {get<uint64_t>(cursor), get<uint64_t>(cursor + 8)};
+                Fingerprint fingerprint;
+                fingerprint.rows = get<uint32_t>(cursor + 16);
+                fingerprint.columns = get<uint32_t>(cursor + 20);
+                fingerprint.parameters = get<uint64_t>(cursor + 24);
+                fingerprint.check = get<uint64_t>(cursor + 32);
+                Result result;
+                result.objective = get<int64_t>(cursor + 40);
+                uint32_t length = get<uint32_t>(cursor + 48);
+                cursor += entryHeaderSize;
+                if (static_cast<size_t>(end - cursor) < length) {
+                    break;
+                }
+                result.sequence.assign(cursor, length);
+                cursor += length;
+                insertLocked(key, fingerprint, std::move(result));
+                loaded++;
+            }
+        }
+        ::munmap(mapped, size);
+        return loaded;
+    }
+
+private:
+    struct Entry {
+        Digest key;
+        Fingerprint fingerprint;
+        Result result;
+    };
+
+    static constexpr char magic[9] = "RESCACHE";
+    static constexpr uint32_t version = 2;
+    static constexpr ptrdiff_t entryHeaderSize = 52; // the fixed fields before the sequence text
+
+    template <typename T>
+    static bool put(FILE* file, T value) {
+        return std::fwrite(&value, sizeof(value), 1, file) == 1;
+    }
+
+    template <typename T>
+    static T get(const char* bytes) {
+        T value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    void insertLocked(const Digest& key, const Fingerprint& fingerprint, Result result) {
+        if (capacity == 0) {
+            return;
+        }
+        auto found = index.find(key);
+        if (found != index.end()) {
+            found->second->fingerprint = fingerprint;
+            found->second->result = std::move(result);
+            entries.splice(entries.begin(), entries, found->second);
+            return;
+        }
+        entries.push_front({key, fingerprint, std::move(result)});
+        index[key] = entries.begin();
+        if (entries.size() > capacity) {
+            index.erase(entries.back().key);
+            entries.pop_back();
+            evictions++;
+        }
+    }
+
+    size_t capacity;
+    std::mutex mutex;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<Digest, std::list<Entry>::iterator, DigestHash> index;
+    long long hits = 0;
+    long long misses = 0;
+    long long collisions = 0;
+    long long evictions = 0;
+};
+
+} // namespace cache
@@ -0,0 +1,122 @@
+#pragma once
+
+// Single-machine scheduling with release (r), processing (p) and delivery (q) times:
+// the task type, reader and Schrage heuristic shared by lab1 and the solver daemon.
+
+#include <algorithm>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+
+namespace rpq
+{
+
+struct Task
+{
+    int id;
+    int preparationTime;
+    int executionTime;
+    int deliveryTime;
+};
+
+// Reads "n" followed by n lines "r p q"; ids are assigned from 1
+inline Task* readTasks(std::istream& in, int& numberOfTasks) 
+{
+    in >> numberOfTasks; // Read the number of records
+    Task* tasks = new Task[numberOfTasks]; // Dynamically allocate array for tasks
+    
+    for (int i = 0; i < numberOfTasks; ++i) 
+    {
+        tasks[i].id = i+1;
+        in >> tasks[i].preparationTime >> tasks[i].executionTime >> tasks[i].deliveryTime;
+    }
+    return tasks;
+}
+
+inline Task* schrageSchedule(Task* tasks, int numberOfTasks) {
+    Task* scheduledTasks = new Task[numberOfTasks];
+    std::vector<Task> tasksVec(tasks, tasks + numberOfTasks);
+    std::vector<Task> readyQueue;
+    int currentTime = 0;
+    int scheduledCount = 0;
+
+    auto compareByDeliveryTime = [](const Task& a, const Task& b) {
+        return a.deliveryTime > b.deliveryTime; // Descending order for delivery time
+    };
+
+    auto compareByPreparationTime = [](const Task& a, const Task& b) {
+        return a.preparationTime < b.preparationTime; // Ascending order for preparation time
+    };
+
+    // Initial sort by preparation time to find the first task(s) to start
+    {
+        INSTRUMENT_PHASE(Sort);
+        std::sort(tasksVec.begin(), tasksVec.end(), compareByPreparationTime);
+    }
+    
+    while (scheduledCount < numberOfTasks) {
+        // Move tasks ready to be processed to the ready queue
+        for (auto it = tasksVec.begin(); it != tasksVec.end();) {
+            if (it->preparationTime <= currentTime) {
+                readyQueue.push_back(*it);
+                INSTRUMENT_COUNT(HeapOperations);
+                it = tasksVec.erase(it); // Remove from tasksVec and add to readyQueue
+            } else {
+                ++it;
+            }
+        }
+
+        // If ready queue is empty, advance time to the next task's preparation time
+        if (readyQueue.empty() && !tasksVec.empty()) {
+            currentTime = tasksVec.front().preparationTime;
+            continue;
+        }
+
+        // Sort ready queue by delivery time to select the task with the highest delivery time
+        std::sort(readyQueue.begin(), readyQueue.end(), compareByDeliveryTime);
+        Task selectedTask = readyQueue.front();
+        readyQueue.erase(readyQueue.begin());
+        INSTRUMENT_COUNT(HeapOperations);
+
+        // "Process" selected task
+        scheduledTasks[scheduledCount++] = selectedTask;
+        currentTime += selectedTask.executionTime;
+    }
+
+    return scheduledTasks;
+}
+
+inline std::string getScheduledTasksSequence(const Task* scheduledTasks, int numberOfTasks) 
+{
+    std::string solution = "";
+    for (int i = 0; i < numberOfTasks; ++i) 
+    {
+        solution += std::to_string(scheduledTasks[i].id);
+        if (i < numberOfTasks - 1) 
+        {
+            solution += " ";
+        }
+    }
+    return solution;
+}
+
+inline int calculateCmax(const Task* scheduledTasks, int numberOfTasks) {
+    int currentTime = 0;
+    int cmax = 0;
+
+    for (int i = 0; i < numberOfTasks; ++i) {
+        const Task& task = scheduledTasks[i];
+        
+        int startTime = std::max(currentTime, task.preparationTime);
+        int finishTime = startTime + task.executionTime + task.deliveryTime;
+        currentTime = startTime + task.executionTime;
+        
+        cmax = std::max(cmax, finishTime);
+    }
+
+    return cmax;
+}
+
+} // namespace rpq
@@ -0,0 +1,385 @@
+#pragma once
+
+// Single-machine total weighted tardiness (WiTi): the task type and the exact
+// subset DPs shared by lab2 and the solver daemon. scheduleTasks walks all 2^n subsets;
+// scheduleTasksSparse only the subsets allowed by precedences derived up front.
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "instrumentation.h"
+
+namespace witi
+{
+
+struct Task
+{
+    int id;
+    int executionTime;
+    int penaltyWeight;
+    int completionTime;
+};
+
+struct Result
+{
+    int time;
+    std::string taskSequence;
+};
+
+// Reads and returns a single task from the input stream
+inline Task readTask(std::istream& in) 
+{
+    Task task;
+    in >> task.executionTime >> task.penaltyWeight >> task.completionTime;
+    return task;
+}
+
+inline Result scheduleTasks(const Task* tasks, int numberOfTasks) 
+{
+    // Convert array to vector for easier manipulation
+    std::vector<Task> taskVector(tasks, tasks + numberOfTasks);
+    
+    // Sort tasks based on a heuristic, smallest penalty weight or other criteria could be considered
+    {
+        INSTRUMENT_PHASE(Sort);
+        std::sort(taskVector.begin(), taskVector.end(), [](const Task& a, const Task& b) 
+        {
+            return a.completionTime < b.completionTime; // Earliest due date first
+        });
+    }
+
+    int n = taskVector.size();
+    std::vector<int> dp(1 << n, INT_MAX); // DP array to store minimum penalty for each subset of tasks
+    dp[0] = 0; // Base case: no tasks scheduled, no penalty
+    std::vector<int> lastTask(1 << n, -1); // To track the last task in optimal sequence
+
+    // Iterate over each subset of tasks; only the DP itself is charged to Evaluate
+    {
+        INSTRUMENT_PHASE(Evaluate);
+        for (int mask = 0; mask < (1 << n); ++mask) 
+        {
+            if (dp[mask] == INT_MAX) continue; // Skip infeasible states
+            INSTRUMENT_COUNT(StatesExpanded);
+
+            int currentTime = 0; // Current time is the sum of execution times of tasks in the current subset
+            for (int i = 0; i < n; ++i) 
+            {
+                if (mask & (1 << i)) 
+                {
+                    currentTime += taskVector[i].executionTime;
+                }
+            }
+
+            // Consider adding each task not yet in the subset
+            for (int i = 0; i < n; ++i) 
+            {
+                if (!(mask & (1 << i))) 
+                {
+                    int nextMask = mask | (1 << i);
+                    int finishTime = currentTime + taskVector[i].executionTime;
+                    int tardiness = std::max(0, finishTime - taskVector[i].completionTime);
+                    int penalty = tardiness * taskVector[i].penaltyWeight;
+
+                    if (dp[nextMask] > dp[mask] + penalty) {
+                        dp[nextMask] = dp[mask] + penalty;
+                        lastTask[nextMask] = i;
+                    }
+                }
+            }
+        }
+    }
+
+    // Reconstruct the optimal task sequence using `lastTask`
+    std::vector<int> sequence;
+    int currentMask = (1 << n) - 1;
+    while (currentMask) 
+    {
+        int taskIdx = lastTask[currentMask];
+        sequence.push_back(taskVector[taskIdx].id);
+        currentMask &= ~(1 << taskIdx); // Remove the last task added from currentMask
+    }
+    std::reverse(sequence.begin(), sequence.end()); // Reverse to get the order from start to finish
+
+    // Convert task sequence to string
+    std::stringstream ss;
+    for (int id : sequence) 
+    {
+        ss << id << " ";
+    }
+
+    return {dp[(1 << n) - 1], ss.str().substr(0, ss.str().size() - 1)}; // Remove the last space
+}
+
+// Precedences of the instance as bitmasks: bit i of predecessors[j] means some optimal
+// schedule runs task i before task j. Derived to a fixpoint with two rules (Rinnooy Kan,
+// Lageweg and Lenstra's extension of Emmons' rules), closed transitively as arcs are added:
+//  - i before j when p_i <= p_j, w_i >= w_j and d_i <= max(d_j, p(predecessors of j) + p_j);
+//    equal p and w are ordered by due date, then index, so no cycle can form
+//  - the fixed tail T (tasks every other task precedes) grows by j when j's successors are
+//    exactly T and d_j >= p(all tasks) - p(T): right in front of T, j is on time, and
+//    moving it there only makes the tasks it passes finish earlier
+inline std::vector<uint64_t> derivePrecedences(const Task* tasks, int numberOfTasks)
+{
+    int n = numberOfTasks;
+    std::vector<uint64_t> predecessors(n, 0);
+    std::vector<uint64_t> successors(n, 0);
+    auto durationOf = [&](uint64_t mask)
+    {
+        long long total = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            if (mask >> k & 1) total += tasks[k].executionTime;
+        }
+        return total;
+    };
+    auto addArc = [&](int from, int to)
+    {
+        uint64_t before = predecessors[from] | uint64_t(1) << from;
+        uint64_t after = successors[to] | uint64_t(1) << to;
+        for (int k = 0; k < n; ++k)
+        {
+            if (before >> k & 1) successors[k] |= after;
+            if (after >> k & 1) predecessors[k] |= before;
+        }
+    };
+    long long totalDuration = durationOf(n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1);
+    uint64_t tail = 0;
+
+    bool changed = true;
+    while (changed) 
+    {
+        changed = false;
+        for (int j = 0; j < n; ++j) 
+        {
+            long long predecessorDuration = durationOf(predecessors[j]);
+            for (int i = 0; i < n; ++i) 
+            {
+                if (i == j || (predecessors[j] >> i & 1) || (predecessors[i] >> j & 1)) continue;
+                const Task& a = tasks[i];
+                const Task& b = tasks[j];
+                bool dominates = a.executionTime <= b.executionTime && a.penaltyWeight >= b.penaltyWeight &&
+                                 a.completionTime <= std::max<long long>(b.completionTime, predecessorDuration + b.executionTime);
+                if (dominates && a.executionTime == b.executionTime && a.penaltyWeight == b.penaltyWeight) 
+                {
+                    dominates = a.completionTime < b.completionTime || (a.completionTime == b.completionTime && i < j);
+                }
+                if (dominates) 
+                {
+                    addArc(i, j);
+                    predecessorDuration = durationOf(predecessors[j]);
+                    changed = true;
+                }
+            }
+        }
+        for (int j = 0; j < n; ++j) 
+        {
+            if ((tail >> j & 1) || (successors[j] & ~tail) != 0 ||
+                tasks[j].completionTime < totalDuration - durationOf(tail)) continue;
+            for (int i = 0; i < n; ++i) 
+            {
+                if (i != j && !(tail >> i & 1) && !(predecessors[j] >> i & 1)) addArc(i, j);
+            }
+            tail |= uint64_t(1) << j;
+            changed = true;
+        }
+    }
+    return predecessors;
+}
+
+struct SparseStats
+{
+    int precedences = 0;       // arcs in the closed precedence relation
+    long long states = 0;      // subsets stored over all levels
+    long long widestLevel = 0; // most subsets of a single size
+    size_t peakBytes = 0;      // state tables plus the reconstruction trail
+    bool exhausted = false;    // stopped at the state budget; the result is then empty
+};
+
+namespace detail
+{
+
+struct SparseState
+{
+    uint64_t mask;
+    int cost;
+    int last;
+};
+
+// Open-addressing (linear probing) map from subset to its best cost; mask 0 marks an
+// empty slot, which is safe because only non-empty subsets are ever inserted
+class StateTable
+{
+public:
+    void reset(size_t expected) 
+    {
+        size_t capacity = 16;
+        while (capacity < expected * 2) capacity <<= 1;
+        slots.assign(capacity, {0, 0, -1});
+        used = 0;
+    }
+
+    void relax(uint64_t mask, int cost, int last) 
+    {
+        size_t slot = find(mask);
+        if (slots[slot].mask == 0) 
+        {
+            slots[slot] = {mask, cost, last};
+            if (++used * 10 > slots.size() * 7) grow();
+        }
+        else if (cost < slots[slot].cost) 
+        {
+            slots[slot].cost = cost;
+            slots[slot].last = last;
+        }
+    }
+
+    size_t size() const { return used; }
+
+    size_t bytes() const { return slots.capacity() * sizeof(SparseState); }
+
+    // Moves the stored states out, leaving the table empty
+    std::vector<SparseState> take() 
+    {
+        std::vector<SparseState> states;
+        states.reserve(used);
+        for (const SparseState& state : slots) 
+        {
+            if (state.mask != 0) states.push_back(state);
+        }
+        std::vector<SparseState>().swap(slots);
+        used = 0;
+        return states;
+    }
+
+private:
+    size_t find(uint64_t mask) const 
+    {
+        size_t wrap = slots.size() - 1;
+        size_t slot = static_cast<size_t>((mask * 0x9e3779b97f4a7c15ULL) >> 20) & wrap;
+        while (slots[slot].mask != 0 && slots[slot].mask != mask) slot = (slot + 1) & wrap;
+        return slot;
+    }
+
+    void grow() 
+    {
+        std::vector<SparseState> old;
+        old.swap(slots);
+        slots.assign(old.size() * 2, {0, 0, -1});
+        for (const SparseState& state : old) 
+        {
+            if (state.mask != 0) slots[find(state.mask)] = state;
+        }
+    }
+
+    std::vector<SparseState> slots;
+    size_t used = 0;
+};
+
+} // namespace detail
+
+// Exact forward DP over the subsets that respect derivePrecedences(), one subset size
+// (level) at a time. A level's cost table is dropped as soon as the next one is built;
+// only a sorted trail of (subset, last task) words per level, 8 bytes per state, stays
+// for rebuilding the sequence. Handles up to 58 tasks; `maxStates` bounds the total work.
+inline Result scheduleTasksSparse(const Task* tasks, int numberOfTasks, SparseStats* stats = nullptr,
+                                  long long maxStates = LLONG_MAX)
+{
+    int n = numberOfTasks;
+    SparseStats local;
+    SparseStats& report = stats != nullptr ? *stats : local;
+    report = SparseStats();
+    if (n <= 0 || n > 58) 
+    {
+        report.exhausted = n > 58;
+        return {n <= 0 ? 0 : -1, ""};
+    }
+
+    std::vector<uint64_t> predecessors = derivePrecedences(tasks, n);
+    for (uint64_t mask : predecessors) report.precedences += __builtin_popcountll(mask);
+
+    // subset durations from eight byte-indexed lookup tables
+    int chunks = (n + 7) / 8;
+    std::vector<int> chunkDuration(chunks * 256, 0);
+    for (int c = 0; c < chunks; ++c) 
+    {
+        for (int bits = 1; bits < 256; ++bits) 
+        {
+            int low = __builtin_ctz(bits);
+            int k = c * 8 + low;
+            chunkDuration[c * 256 + bits] = chunkDuration[c * 256 + (bits & (bits - 1))] + (k < n ? tasks[k].executionTime : 0);
+        }
+    }
+    auto durationOf = [&](uint64_t mask) 
+    {
+        int total = 0;
+        for (int c = 0; c < chunks; ++c) total += chunkDuration[c * 256 + (mask >> (8 * c) & 0xff)];
+        return total;
+    };
+
+    std::vector<std::vector<uint64_t>> trail(n + 1);
+    std::vector<detail::SparseState> level = {{0, 0, -1}};
+    detail::StateTable next;
+    size_t trailBytes = 0;
+    // expand level by level; reconstruction below is left unattributed
+    {
+        INSTRUMENT_PHASE(Evaluate);
+        for (int size = 0; size < n; ++size) 
+        {
+            next.reset(level.size());
+            for (const detail::SparseState& state : level) 
+            {
+                INSTRUMENT_COUNT(StatesExpanded);
+                int time = durationOf(state.mask);
+                for (int j = 0; j < n; ++j) 
+                {
+                    if ((state.mask >> j & 1) || (predecessors[j] & ~state.mask) != 0) continue;
+                    int finish = time + tasks[j].executionTime;
+                    int penalty = std::max(0, finish - tasks[j].completionTime) * tasks[j].penaltyWeight;
+                    next.relax(state.mask | uint64_t(1) << j, state.cost + penalty, j);
+                }
+            }
+            report.peakBytes = std::max(report.peakBytes, level.capacity() * sizeof(detail::SparseState) + next.bytes() + trailBytes);
+            report.states += next.size();
+            report.widestLevel = std::max<long long>(report.widestLevel, next.size());
+            if (report.states > maxStates) 
+            {
+                report.exhausted = true;
+                return {-1, ""};
+            }
+
+            level = next.take();
+            std::vector<uint64_t>& words = trail[size + 1];
+            words.reserve(level.size());
+            for (const detail::SparseState& state : level) words.push_back(state.mask << 6 | static_cast<uint64_t>(state.last));
+            std::sort(words.begin(), words.end());
+            trailBytes += words.capacity() * sizeof(uint64_t);
+        }
+    }
+
+    // walk the trail back from the full set
+    std::vector<int> sequence(n);
+    uint64_t mask = level[0].mask;
+    for (int size = n; size > 0; --size) 
+    {
+        const std::vector<uint64_t>& words = trail[size];
+        uint64_t word = *std::lower_bound(words.begin(), words.end(), mask << 6);
+        int last = static_cast<int>(word & 63);
+        sequence[size - 1] = tasks[last].id;
+        mask &= ~(uint64_t(1) << last);
+    }
+
+    std::string text;
+    for (int i = 0; i < n; ++i) 
+    {
+        text += std::to_string(sequence[i]);
+        if (i + 1 < n) text += " ";
+    }
+    return {level[0].cost, text};
+}
+
+} // namespace witi
@@ -0,0 +1,514 @@
+// Resident solver daemon: keeps a warm work-stealing pool behind a Unix domain socket
+// so that clients pay neither process start-up nor thread creation per instance.
+//
+//   g++ -O2 -std=c++17 -pthread main.cpp -o solverd
+//   ./solverd serve /tmp/solverd.sock [threads] [--cache results.cache] [--cache-entries N]
+//   ./solverd load /tmp/solverd.sock neh ../lab3/neh.data.txt [requests] [connections] [batch] [--binary]
+//
+// `load` replays the instances of a lab data file (every "data.XXX:" block, or the whole
+// file when it has none) and reports throughput and p50/p99 latency, both round-trip as
+// seen by the client and service time as reported by the daemon. See protocol.h for
+// the framing.
+//
+// Solved instances are remembered in a content-addressed LRU cache (common/result_cache.h)
+// and answered from it when resubmitted; with --cache the entries are loaded from that
+// file at start-up and written back on SAVE, SIGINT or SIGTERM. --cache-entries 0 turns
+// caching off.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../common/benchmark.h"
+#include "../common/result_cache.h"
+#include "protocol.h"
+#include "solvers.h"
+#include "work_stealing_pool.h"
+
+using namespace std;
+using protocol::Connection;
+using protocol::Request;
+using protocol::Response;
+
+// Service times of the most recent requests, for STATS
+class LatencyLog {
+public:
+    void add(double micros) {
+        lock_guard<mutex> lock(guard);
+        samples[count++ % samples.size()] = micros;
+    }
+
+    string describe() {
+        lock_guard<mutex> lock(guard);
+        vector<double> recent(samples.begin(), samples.begin() + min<size_t>(count, samples.size()));
+        ostringstream line;
+        line << "served=" << count;
+        if (!recent.empty()) {
+            line << " p50_us=" << static_cast<long long>(benchmark::detail::percentile(recent, 0.5))
+                 << " p99_us=" << static_cast<long long>(benchmark::detail::percentile(recent, 0.99));
+        }
+        return line.str();
+    }
+
+private:
+    mutex guard;
+    vector<double> samples = vector<double>(1 << 16);
+    long long count = 0;
+};
+
+volatile sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+class Server {
+public:
+    Server(const string& socketPath, int threadCount, const string& cachePath, size_t cacheEntries)
+        : socketPath(socketPath), cachePath(cachePath), cache(cacheEntries), pool(threadCount) {}
+
+    int run() {
+        int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (listener < 0 || socketPath.size() >= sizeof(address.sun_path)) {
+            cerr << "Error: Cannot create socket: " << socketPath << endl;
+            return 1;
+        }
+        strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+        ::unlink(socketPath.c_str());
+        if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(listener, 128) < 0) {
+            cerr << "Error: Cannot listen on socket: " << socketPath << endl;
+            ::close(listener);
+            return 1;
+        }
+        if (!cachePath.empty()) {
+            cout << "loaded " << cache.load(cachePath) << " cached results from " << cachePath << endl;
+        }
+        cout << "solverd listening on " << socketPath << " with " << pool.size() << " workers" << endl;
+
+        // without SA_RESTART a signal interrupts accept() so the loop can save and exit
+        struct sigaction action = {};
+        action.sa_handler = requestStop;
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+        while (!stopRequested) {
+            int client = ::accept(listener, nullptr, nullptr);
+            if (client < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            reapClients();
+            lock_guard<mutex> lock(clientsGuard);
+            clients.emplace_back();
+            Client& record = clients.back();
+            record.fd = client;
+            record.worker = thread([this, &record]() { serveClient(record); });
+        }
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+        // unblock every client still reading, then wait for all of them before saving
+        {
+            lock_guard<mutex> lock(clientsGuard);
+            for (Client& record : clients) {
+                if (record.open) {
+                    ::shutdown(record.fd, SHUT_RDWR);
+                }
+            }
+        }
+        for (Client& record : clients) {
+            record.worker.join();
+        }
+        clients.clear();
+        if (!cachePath.empty() && !cache.save(cachePath)) {
+            cerr << "Error: Cannot write cache file: " << cachePath << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+private:
+    using Clock = chrono::steady_clock;
+
+    struct Client {
+        int fd = -1;
+        bool open = true;     // descriptor not yet closed; guarded by clientsGuard
+        bool finished = false; // serveClient has returned; guarded by clientsGuard
+        thread worker;
+    };
+
+    void serveClient(Client& record) {
+        {
+            Connection connection(record.fd);
+            try {
+                serve(connection);
+            } catch (const exception& failure) {
+                // one bad client must not take the server down; it is told and disconnected
+                connection.writeAll(string("ERR internal error: ") + failure.what() + "\n");
+            }
+            // cleared before the connection closes the descriptor, so run() never shuts down a reused one
+            lock_guard<mutex> lock(clientsGuard);
+            record.open = false;
+        }
+        lock_guard<mutex> lock(clientsGuard);
+        record.finished = true;
+    }
+
+    // Joins the threads of clients that have disconnected
+    void reapClients() {
+        lock_guard<mutex> lock(clientsGuard);
+        for (auto record = clients.begin(); record != clients.end();) {
+            if (record->finished) {
+                record->worker.join();
+                record = clients.erase(record);
+            } else {
+                ++record;
+            }
+        }
+    }
+
+    future<Response> submit(Request request, const string& error) {
+        auto received = Clock::now();
+        auto promised = make_shared<promise<Response>>();
+        future<Response> result = promised->get_future();
+        if (!error.empty()) {
+            Response response;
+            response.error = error;
+            promised->set_value(response);
+            return result;
+        }
+        cache::Digest key = solvers::cacheKey(request);
+        cache::Fingerprint fingerprint = solvers::cacheFingerprint(request);
+        cache::Result cached;
+        if (cache.find(key, fingerprint, cached)) {
+            Response response;
+            response.ok = true;
+            response.objective = cached.objective;
+            response.sequence = move(cached.sequence);
+            response.latencyMicros = chrono::duration<double, micro>(Clock::now() - received).count();
+            latencies.add(response.latencyMicros);
+            promised->set_value(move(response));
+            return result;
+        }
+        auto shared = make_shared<Request>(move(request));
+        pool.submit([this, shared, promised, received, key, fingerprint]() {
+            Response response;
+            try {
+                response = solvers::solve(*shared);
+                response.latencyMicros = chrono::duration<double, micro>(Clock::now() - received).count();
+                if (response.ok) {
+                    latencies.add(response.latencyMicros);
+                    cache.insert(key, fingerprint, {response.objective, response.sequence});
+                }
+            } catch (const exception& failure) {
+                response = Response();
+                response.error = string("internal error: ") + failure.what();
+            }
+            promised->set_value(move(response));
+        });
+        return result;
+    }
+
+    // Reads one SOLVE or binary frame; false when the connection is gone
+    bool readFrame(Connection& connection, future<Response>& result) {
+        Request request;
+        string error;
+        if (!connection.fill(4)) {
+            return false;
+        }
+        if (protocol::isBinaryFrame(connection)) {
+            if (!protocol::readBinaryRequest(connection, request, error)) {
+                return false;
+            }
+        } else {
+            string line;
+            if (!connection.readLine(line)) {
+                return false;
+            }
+            if (line.compare(0, 6, "SOLVE ") != 0) {
+                error = "expected SOLVE";
+            } else if (!protocol::readRequest(connection, line, request, error)) {
+                return false;
+            }
+        }
+        result = submit(move(request), error);
+        return true;
+    }
+
+    void serve(Connection& connection) {
+        string line;
+        while (connection.fill(4)) {
+            string reply;
+            if (protocol::isBinaryFrame(connection) || memcmp(connection.data(), "SOLV", 4) == 0) {
+                future<Response> result;
+                if (!readFrame(connection, result)) {
+                    return;
+                }
+                reply = protocol::encodeResponse(result.get());
+            } else {
+                if (!connection.readLine(line)) {
+                    return;
+                }
+                int count = 0;
+                if (sscanf(line.c_str(), "BATCH %d", &count) == 1 && count > protocol::maxBatch) {
+                    // the frames that follow cannot be skipped without reading them; drop the client
+                    connection.writeAll("ERR batch larger than " + to_string(protocol::maxBatch) + "\n");
+                    return;
+                } else if (count > 0) {
+                    // every request of the batch is queued before the first answer is awaited
+                    vector<future<Response>> results(count);
+                    for (future<Response>& result : results) {
+                        if (!readFrame(connection, result)) {
+                            return;
+                        }
+                    }
+                    for (future<Response>& result : results) {
+                        reply += protocol::encodeResponse(result.get());
+                    }
+                } else if (line == "STATS") {
+                    cache::Counters counters = cache.counters();
+                    reply = "OK " + latencies.describe() + " workers=" + to_string(pool.size()) +
+                            " cache_hits=" + to_string(counters.hits) + " cache_misses=" + to_string(counters.misses) +
+                            " cache_collisions=" + to_string(counters.collisions) +
+                            " cache_entries=" + to_string(counters.entries) +
+                            " cache_evictions=" + to_string(counters.evictions) + "\n";
+                } else if (line == "SAVE") {
+                    reply = !cachePath.empty() && cache.save(cachePath) ? "OK saved\n" : "ERR cannot save cache\n";
+                } else if (line == "QUIT") {
+                    return;
+                } else {
+                    reply = "ERR unknown command\n";
+                }
+            }
+            if (!connection.writeAll(reply)) {
+                return;
+            }
+        }
+    }
+
+    string socketPath;
+    string cachePath;
+    cache::ResultCache cache;
+    LatencyLog latencies;
+    mutex clientsGuard;
+    list<Client> clients;
+    // declared last so it is destroyed first: its workers finish their tasks while the
+    // cache and the latency log they write to still exist
+    WorkStealingPool pool;
+};
+
+int connectTo(const string& socketPath) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        return fd;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    return -1;
+}
+
+// Instances of a lab data file, one payload per "data.XXX:" block
+vector<Request> loadRequests(const string& filePath, protocol::Problem problem) {
+    ifstream file(filePath, ios::binary);
+    if (!file.is_open()) {
+        cerr << "Error: Cannot open file: " << filePath << endl;
+        return {};
+    }
+    string contents((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    vector<size_t> starts;
+    for (size_t at = contents.find("data."); at != string::npos; at = contents.find("data.", at + 5)) {
+        starts.push_back(at);
+    }
+    if (starts.empty()) {
+        starts.push_back(0);
+    }
+    starts.push_back(contents.size());
+
+    vector<Request> requests;
+    for (size_t i = 0; i + 1 < starts.size(); i++) {
+        Request request;
+        string error;
+        if (protocol::parseText(problem, contents.data() + starts[i], contents.data() + starts[i + 1], request, error)) {
+            requests.push_back(move(request));
+        }
+    }
+    return requests;
+}
+
+int runLoad(const string& socketPath, protocol::Problem problem, const string& filePath, int requestCount,
+            int connectionCount, int batchSize, bool binary) {
+    vector<Request> instances = loadRequests(filePath, problem);
+    if (instances.empty()) {
+        cerr << "Error: No instances in " << filePath << endl;
+        return 1;
+    }
+    vector<string> frames;
+    for (const Request& instance : instances) {
+        frames.push_back(binary ? protocol::encodeBinary(instance) : protocol::encodeText(instance));
+    }
+
+    vector<vector<double>> roundTrips(connectionCount);
+    vector<vector<double>> serviceTimes(connectionCount);
+    atomic<int> next(0);
+    atomic<int> errors(0);
+    atomic<bool> broken(false);
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> clients;
+    for (int c = 0; c < connectionCount; c++) {
+        clients.emplace_back([&, c]() {
+            int fd = connectTo(socketPath);
+            if (fd < 0) {
+                broken = true;
+                return;
+            }
+            Connection connection(fd);
+            while (true) {
+                int first = next.fetch_add(batchSize);
+                if (first >= requestCount) {
+                    break;
+                }
+                int count = min(batchSize, requestCount - first);
+                string message = batchSize > 1 ? "BATCH " + to_string(count) + "\n" : "";
+                for (int r = first; r < first + count; r++) {
+                    message += frames[r % frames.size()];
+                }
+                auto sent = chrono::steady_clock::now();
+                if (!connection.writeAll(message)) {
+                    broken = true;
+                    return;
+                }
+                for (int r = 0; r < count; r++) {
+                    Response response;
+                    if (!protocol::readResponse(connection, response)) {
+                        broken = true;
+                        return;
+                    }
+                    if (!response.ok) {
+                        errors++;
+                        continue;
+                    }
+                    serviceTimes[c].push_back(response.latencyMicros);
+                }
+                // requests of a batch share the round trip of the whole batch
+                double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - sent).count();
+                roundTrips[c].insert(roundTrips[c].end(), count, micros);
+            }
+        });
+    }
+    for (thread& client : clients) {
+        client.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (broken) {
+        cerr << "Error: Connection to " << socketPath << " failed" << endl;
+        return 1;
+    }
+
+    vector<double> roundTrip;
+    vector<double> service;
+    for (int c = 0; c < connectionCount; c++) {
+        roundTrip.insert(roundTrip.end(), roundTrips[c].begin(), roundTrips[c].end());
+        service.insert(service.end(), serviceTimes[c].begin(), serviceTimes[c].end());
+    }
+    cout << fixed << setprecision(1);
+    cout << protocol::problemName(problem) << ": " << requestCount << " requests over " << connectionCount
+         << " connections, batch " << batchSize << (binary ? ", binary" : ", text") << " framing" << endl;
+    cout << "throughput: " << requestCount / seconds << " req/s, errors: " << errors << endl;
+    cout << "round trip  p50: " << benchmark::detail::percentile(roundTrip, 0.5)
+         << " us  p99: " << benchmark::detail::percentile(roundTrip, 0.99) << " us" << endl;
+    if (!service.empty()) {
+        cout << "service     p50: " << benchmark::detail::percentile(service, 0.5)
+             << " us  p99: " << benchmark::detail::percentile(service, 0.99) << " us" << endl;
+    }
+
+    int fd = connectTo(socketPath);
+    if (fd >= 0) {
+        Connection connection(fd);
+        string stats;
+        if (connection.writeAll("STATS\n") && connection.readLine(stats)) {
+            cout << "daemon: " << stats.substr(stats.find(' ') + 1) << endl;
+        }
+    }
+    return 0;
+}
+
+int usage() {
+    cerr << "Usage: solverd serve <socket> [threads] [--cache <file>] [--cache-entries N]" << endl;
+    cerr << "       solverd load <socket> <rpq|witi|neh|anneal> <data file> [requests] [connections] [batch] [--binary]"
+         << endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    signal(SIGPIPE, SIG_IGN);
+    if (argc < 3) {
+        return usage();
+    }
+    string mode = argv[1];
+    string socketPath = argv[2];
+
+    if (mode == "serve") {
+        int threads = static_cast<int>(thread::hardware_concurrency());
+        string cachePath;
+        long long cacheEntries = 100000;
+        for (int i = 3; i < argc; i++) {
+            string argument = argv[i];
+            if (argument == "--cache" && i + 1 < argc) {
+                cachePath = argv[++i];
+            } else if (argument == "--cache-entries" && i + 1 < argc) {
+                cacheEntries = atoll(argv[++i]);
+            } else {
+                threads = atoi(argv[i]);
+            }
+        }
+        Server server(socketPath, max(1, threads), cachePath, static_cast<size_t>(max(0LL, cacheEntries)));
+        return server.run();
+    }
+
+    if (mode == "load" && argc >= 5) {
+        protocol::Problem problem;
+        if (!protocol::parseProblem(argv[3], problem)) {
+            return usage();
+        }
+        vector<string> positional;
+        bool binary = false;
+        for (int i = 5; i < argc; i++) {
+            if (string(argv[i]) == "--binary") {
+                binary = true;
+            } else {
+                positional.push_back(argv[i]);
+            }
+        }
+        int requests = positional.size() > 0 ? atoi(positional[0].c_str()) : 1000;
+        int connections = positional.size() > 1 ? atoi(positional[1].c_str()) : 4;
+        int batch = positional.size() > 2 ? atoi(positional[2].c_str()) : 1;
+        if (requests < 1 || connections < 1 || batch < 1) {
+            return usage();
+        }
+        return runLoad(socketPath, problem, argv[4], requests, connections, batch, binary);
+    }
+    return usage();
+}
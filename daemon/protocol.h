@@ -0,0 +1,360 @@
+#pragma once
+
+// Wire protocol of the solver daemon, shared by the server and the load generator.
+//
+// A request is framed either as text or as binary:
+//   text:   "SOLVE <problem> <payload-bytes> [cycles]\n" followed by the payload, which
+//           is an instance in the labs' own file format (lab1 "n / r p q", lab2 "n / p w d",
+//           lab3 "n m / times"); an optional leading "data.XXX:" tag and anything after
+//           the instance (opt:, neh: sections) are ignored
+//   binary: a 24-byte little-endian header {"SLVB", problem, jobs, columns, cycles, 0}
+//           followed by jobs * columns int32 values in the same job-major order
+// "BATCH <count>\n" is followed by `count` framed requests which are solved concurrently
+// and answered in order. "STATS\n" returns one line of server counters and "SAVE\n"
+// writes the result cache to its file. A payload is limited to maxFrameBytes and a batch
+// to maxBatch requests; a frame over either limit closes the connection, as the rest of
+// the stream can no longer be framed.
+//
+// Every request is answered with
+//   "OK <objective> <latency-us>\n<space separated 1-based sequence>\n"   or   "ERR <reason>\n"
+// where the latency is measured inside the daemon from the end of the frame to the
+// end of the solve, so it includes queueing in the worker pool.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace protocol {
+
+enum class Problem : uint32_t { Rpq = 0, Witi = 1, Neh = 2, Anneal = 3 };
+
+constexpr char binaryMagic[4] = {'S', 'L', 'V', 'B'};
+constexpr size_t binaryHeaderSize = 24;
+constexpr int maxJobs = 1 << 20;
+constexpr int maxColumns = 1 << 10;
+constexpr size_t maxFrameBytes = 64 << 20;     // payload of one request, text or binary
+constexpr size_t maxCells = maxFrameBytes / 4; // jobs * columns of one request
+constexpr int maxBatch = 4096;                 // requests in one BATCH
+
+inline const char* problemName(Problem problem) {
+    switch (problem) {
+    case Problem::Rpq:
+        return "rpq";
+    case Problem::Witi:
+        return "witi";
+    case Problem::Neh:
+        return "neh";
+    case Problem::Anneal:
+        return "anneal";
+    }
+    return "?";
+}
+
+inline bool parseProblem(const std::string& name, Problem& problem) {
+    for (uint32_t p = 0; p <= static_cast<uint32_t>(Problem::Anneal); p++) {
+        if (name == problemName(static_cast<Problem>(p))) {
+            problem = static_cast<Problem>(p);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Decoded instance: `values` is jobCount rows of `columns` integers (r p q, p w d, or one
+// processing time per machine)
+struct Request {
+    Problem problem = Problem::Rpq;
+    int jobCount = 0;
+    int columns = 0;
+    int cycles = 0; // annealing iterations; 0 picks the server default
+    std::vector<int> values;
+};
+
+struct Response {
+    bool ok = false;
+    long long objective = 0;
+    double latencyMicros = 0;
+    std::string sequence;
+    std::string error;
+};
+
+// Reads the instance of `problem` from a payload in the labs' text format
+inline bool parseText(Problem problem, const char* begin, const char* end, Request& request, std::string& error) {
+    const char* cursor = begin;
+    auto skipSpace = [&]() {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n')) {
+            cursor++;
+        }
+    };
+    auto readInt = [&](int& value) {
+        skipSpace();
+        if (cursor == end || *cursor < '0' || *cursor > '9') {
+            return false;
+        }
+        long long parsed = 0;
+        while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+            parsed = parsed * 10 + (*cursor - '0');
+            if (parsed > INT32_MAX) {
+                return false;
+            }
+            cursor++;
+        }
+        value = static_cast<int>(parsed);
+        return true;
+    };
+
+    skipSpace();
+    if (end - cursor >= 5 && std::memcmp(cursor, "data.", 5) == 0) {
+        while (cursor < end && *cursor != ':') {
+            cursor++;
+        }
+        cursor++;
+    }
+
+    request.problem = problem;
+    request.columns = 3;
+    bool flowShop = problem == Problem::Neh || problem == Problem::Anneal;
+    if (!readInt(request.jobCount) || (flowShop && !readInt(request.columns))) {
+        error = "missing instance size";
+        return false;
+    }
+    if (request.jobCount < 1 || request.jobCount > maxJobs || request.columns < 1 || request.columns > maxColumns ||
+        static_cast<size_t>(request.jobCount) * request.columns > maxCells) {
+        error = "instance size out of range";
+        return false;
+    }
+    // every value takes at least a digit and a separator; reject before allocating
+    if (static_cast<size_t>(request.jobCount) * request.columns > static_cast<size_t>(end - cursor) / 2 + 1) {
+        error = "truncated instance";
+        return false;
+    }
+    request.values.resize(static_cast<size_t>(request.jobCount) * request.columns);
+    for (int& value : request.values) {
+        if (!readInt(value)) {
+            error = "truncated instance";
+            return false;
+        }
+    }
+    return true;
+}
+
+inline std::string encodeText(const Request& request) {
+    std::string payload = std::to_string(request.jobCount);
+    if (request.problem == Problem::Neh || request.problem == Problem::Anneal) {
+        payload += " " + std::to_string(request.columns);
+    }
+    payload += "\n";
+    for (int j = 0; j < request.jobCount; j++) {
+        for (int c = 0; c < request.columns; c++) {
+            payload += std::to_string(request.values[static_cast<size_t>(j) * request.columns + c]);
+            payload += c + 1 < request.columns ? " " : "\n";
+        }
+    }
+    std::string frame = "SOLVE " + std::string(problemName(request.problem)) + " " + std::to_string(payload.size());
+    if (request.cycles > 0) {
+        frame += " " + std::to_string(request.cycles);
+    }
+    return frame + "\n" + payload;
+}
+
+inline void putWord(std::string& out, uint32_t word) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>(word >> shift & 0xff));
+    }
+}
+
+inline uint32_t getWord(const char* in) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in);
+    return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+inline std::string encodeBinary(const Request& request) {
+    std::string frame(binaryMagic, 4);
+    frame.reserve(binaryHeaderSize + request.values.size() * 4);
+    putWord(frame, static_cast<uint32_t>(request.problem));
+    putWord(frame, request.jobCount);
+    putWord(frame, request.columns);
+    putWord(frame, request.cycles);
+    putWord(frame, 0);
+    for (int value : request.values) {
+        putWord(frame, static_cast<uint32_t>(value));
+    }
+    return frame;
+}
+
+inline std::string encodeResponse(const Response& response) {
+    if (!response.ok) {
+        return "ERR " + response.error + "\n";
+    }
+    return "OK " + std::to_string(response.objective) + " " + std::to_string(static_cast<long long>(response.latencyMicros)) +
+           "\n" + response.sequence + "\n";
+}
+
+// Buffered reads and full writes on a connected stream socket
+class Connection {
+public:
+    explicit Connection(int fd) : fd(fd) {}
+
+    ~Connection() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // Makes at least `count` bytes available at data(); false on EOF or error
+    bool fill(size_t count) {
+        if (start > 0 && buffer.size() - start < count) {
+            buffer.erase(0, start);
+            start = 0;
+        }
+        char chunk[1 << 16];
+        while (buffer.size() - start < count) {
+            ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                return false;
+            }
+            buffer.append(chunk, got);
+        }
+        return true;
+    }
+
+    const char* data() const {
+        return buffer.data() + start;
+    }
+
+    void consume(size_t count) {
+        start += count;
+    }
+
+    bool readLine(std::string& line) {
+        size_t newline;
+        while ((newline = buffer.find('\n', start)) == std::string::npos) {
+            if (!fill(buffer.size() - start + 1)) {
+                return false;
+            }
+        }
+        line.assign(buffer, start, newline - start);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        start = newline + 1;
+        return true;
+    }
+
+    bool writeAll(const std::string& bytes) {
+        size_t sent = 0;
+        while (sent < bytes.size()) {
+            ssize_t wrote = ::send(fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+            if (wrote < 0 && errno == EINTR) {
+                continue;
+            }
+            if (wrote <= 0) {
+                return false;
+            }
+            sent += wrote;
+        }
+        return true;
+    }
+
+private:
+    int fd;
+    std::string buffer;
+    size_t start = 0;
+};
+
+// Reads one framed request. Returns false when the connection is gone; a malformed
+// frame that can still be skipped sets `error` instead.
+inline bool readRequest(Connection& connection, const std::string& firstLine, Request& request, std::string& error) {
+    // firstLine is "SOLVE <problem> <bytes> [cycles]"
+    char name[16] = {};
+    long long bytes = -1;
+    int cycles = 0;
+    if (std::sscanf(firstLine.c_str(), "SOLVE %15s %lld %d", name, &bytes, &cycles) < 2 || bytes < 0) {
+        error = "malformed SOLVE line";
+        return true;
+    }
+    if (bytes > static_cast<long long>(maxFrameBytes) || !connection.fill(bytes)) {
+        return false;
+    }
+    Problem problem;
+    if (!parseProblem(name, problem)) {
+        error = "unknown problem";
+    } else if (parseText(problem, connection.data(), connection.data() + bytes, request, error)) {
+        request.cycles = cycles;
+    }
+    connection.consume(bytes);
+    return true;
+}
+
+inline bool readBinaryRequest(Connection& connection, Request& request, std::string& error) {
+    if (!connection.fill(binaryHeaderSize)) {
+        return false;
+    }
+    const char* header = connection.data();
+    uint32_t problem = getWord(header + 4);
+    uint32_t jobs = getWord(header + 8);
+    uint32_t columns = getWord(header + 12);
+    request.cycles = static_cast<int>(getWord(header + 16));
+    if (jobs < 1 || jobs > static_cast<uint32_t>(maxJobs) || columns < 1 || columns > static_cast<uint32_t>(maxColumns) ||
+        static_cast<size_t>(jobs) * columns > maxCells) {
+        return false; // the payload is not read, so the stream cannot be resynchronised
+    }
+    size_t payload = static_cast<size_t>(jobs) * columns * 4;
+    if (!connection.fill(binaryHeaderSize + payload)) {
+        return false;
+    }
+    const char* values = connection.data() + binaryHeaderSize;
+    request.problem = static_cast<Problem>(problem);
+    request.jobCount = jobs;
+    request.columns = columns;
+    request.values.resize(static_cast<size_t>(jobs) * columns);
+    for (size_t i = 0; i < request.values.size(); i++) {
+        request.values[i] = static_cast<int>(getWord(values + 4 * i));
+    }
+    connection.consume(binaryHeaderSize + payload);
+    if (problem > static_cast<uint32_t>(Problem::Anneal)) {
+        error = "unknown problem";
+    } else if ((request.problem == Problem::Rpq || request.problem == Problem::Witi) && columns != 3) {
+        error = "expected 3 columns";
+    }
+    return true;
+}
+
+inline bool isBinaryFrame(const Connection& connection) {
+    return std::memcmp(connection.data(), binaryMagic, 4) == 0;
+}
+
+// Reads the answer to one request on the client side
+inline bool readResponse(Connection& connection, Response& response) {
+    std::string line;
+    if (!connection.readLine(line)) {
+        return false;
+    }
+    if (line.compare(0, 4, "ERR ") == 0) {
+        response.ok = false;
+        response.error = line.substr(4);
+        return true;
+    }
+    long long latency = 0;
+    if (std::sscanf(line.c_str(), "OK %lld %lld", &response.objective, &latency) != 2) {
+        return false;
+    }
+    response.ok = true;
+    response.latencyMicros = static_cast<double>(latency);
+    return connection.readLine(response.sequence);
+}
+
+} // namespace protocol
@@ -0,0 +1,164 @@
+#pragma once
+
+// Runs a decoded request through the lab engines: Schrage (lab1), the sparse WiTi DP
+// (lab2), NEH with Taillard's acceleration (lab3) and NEH-seeded annealing (lab4).
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../common/annealing.h"
+#include "../common/flowshop.h"
+#include "../common/metaheuristics.h"
+#include "../common/problems.h"
+#include "../common/result_cache.h"
+#include "../common/rpq.h"
+#include "../common/witi.h"
+#include "protocol.h"
+
+namespace solvers {
+
+constexpr long long maxWitiStates = 50000000; // about 1 GB of state tables and trail
+constexpr int defaultAnnealingCycles = 20000;
+
+inline std::string joinSequence(const std::vector<int>& order) {
+    std::string sequence;
+    for (size_t i = 0; i < order.size(); i++) {
+        if (i > 0) {
+            sequence += " ";
+        }
+        sequence += std::to_string(order[i] + 1);
+    }
+    return sequence;
+}
+
+inline flowshop::Instance toInstance(const protocol::Request& request) {
+    flowshop::Instance instance;
+    instance.jobCount = request.jobCount;
+    instance.machineCount = request.columns;
+    instance.times = request.values;
+    instance.totalTimes.assign(request.jobCount, 0);
+    for (int j = 0; j < request.jobCount; j++) {
+        for (int m = 0; m < request.columns; m++) {
+            instance.totalTimes[j] += instance.job(j)[m];
+        }
+    }
+    return instance;
+}
+
+inline protocol::Response solveRpq(const protocol::Request& request) {
+    std::vector<rpq::Task> tasks(request.jobCount);
+    for (int j = 0; j < request.jobCount; j++) {
+        const int* row = &request.values[static_cast<size_t>(j) * 3];
+        tasks[j] = {j + 1, row[0], row[1], row[2]};
+    }
+    rpq::Task* scheduled = rpq::schrageSchedule(tasks.data(), request.jobCount);
+    protocol::Response response;
+    response.ok = true;
+    response.objective = rpq::calculateCmax(scheduled, request.jobCount);
+    response.sequence = rpq::getScheduledTasksSequence(scheduled, request.jobCount);
+    delete[] scheduled;
+    return response;
+}
+
+inline protocol::Response solveWiti(const protocol::Request& request) {
+    protocol::Response response;
+    std::vector<witi::Task> tasks(request.jobCount);
+    for (int j = 0; j < request.jobCount; j++) {
+        const int* row = &request.values[static_cast<size_t>(j) * 3];
+        tasks[j] = {j + 1, row[0], row[1], row[2]};
+    }
+    witi::SparseStats stats;
+    witi::Result result = witi::scheduleTasksSparse(tasks.data(), request.jobCount, &stats, maxWitiStates);
+    if (stats.exhausted) {
+        response.error = "witi instance exceeds the state budget";
+        return response;
+    }
+    response.ok = true;
+    response.objective = result.time;
+    response.sequence = result.taskSequence;
+    return response;
+}
+
+// The algorithm and its resolved parameters in one word; only annealing has any
+inline uint64_t cacheParameters(const protocol::Request& request) {
+    int cycles = 0;
+    if (request.problem == protocol::Problem::Anneal) {
+        cycles = request.cycles > 0 ? request.cycles : defaultAnnealingCycles;
+    }
+    return static_cast<uint64_t>(request.problem) << 32 | static_cast<uint32_t>(cycles);
+}
+
+// Digest of the decoded instance and everything that changes the answer: the algorithm,
+// its resolved parameters and the layout of the values
+inline cache::Digest cacheKey(const protocol::Request& request) {
+    cache::Hasher hasher;
+    hasher.add(cacheParameters(request));
+    hasher.add(static_cast<uint64_t>(request.jobCount) << 32 | static_cast<uint32_t>(request.columns));
+    hasher.add(request.values.data(), request.values.size());
+    return hasher.finish();
+}
+
+// What a cached entry found under cacheKey must also match before it is served
+inline cache::Fingerprint cacheFingerprint(const protocol::Request& request) {
+    cache::Checksum checksum;
+    checksum.add(request.values.data(), request.values.size());
+    cache::Fingerprint fingerprint;
+    fingerprint.rows = static_cast<uint32_t>(request.jobCount);
+    fingerprint.columns = static_cast<uint32_t>(request.columns);
+    fingerprint.parameters = cacheParameters(request);
+    fingerprint.check = checksum.finish();
+    return fingerprint;
+}
+
+// Calibrates the temperatures the way lab4 does and anneals from the NEH order. Each
+// request draws from its own engine seeded with its digest, so identical requests get
+// identical answers whatever else the pool is running.
+inline std::vector<int> anneal(const flowshop::Instance& instance, std::vector<int> order, int cycles,
+                               const cache::Digest& seed) {
+    if (instance.jobCount < 2) {
+        return order;
+    }
+    std::seed_seq words = {static_cast<uint32_t>(seed.high >> 32), static_cast<uint32_t>(seed.high),
+                           static_cast<uint32_t>(seed.low >> 32), static_cast<uint32_t>(seed.low)};
+    Random random(words);
+    try {
+        meta::AnnealingSettings settings = calibrateAnnealing(instance, cycles, {0.2, 0.6, 0.2, 4}, random);
+        meta::FlowShopProblem problem(instance, order);
+        return meta::anneal(problem, settings, random).order;
+    } catch (const std::invalid_argument&) {
+        return order; // every permutation has the same makespan
+    }
+}
+
+inline protocol::Response solveFlowShop(const protocol::Request& request) {
+    flowshop::Instance instance = toInstance(request);
+    std::vector<int> order = flowshop::optimizedNEH(instance);
+    if (request.problem == protocol::Problem::Anneal) {
+        order = anneal(instance, order, request.cycles > 0 ? request.cycles : defaultAnnealingCycles, cacheKey(request));
+    }
+    protocol::Response response;
+    response.ok = true;
+    response.objective = flowshop::makespan(instance, order);
+    response.sequence = joinSequence(order);
+    return response;
+}
+
+inline protocol::Response solve(const protocol::Request& request) {
+    switch (request.problem) {
+    case protocol::Problem::Rpq:
+        return solveRpq(request);
+    case protocol::Problem::Witi:
+        return solveWiti(request);
+    case protocol::Problem::Neh:
+    case protocol::Problem::Anneal:
+        return solveFlowShop(request);
+    }
+    protocol::Response response;
+    response.error = "unknown problem";
+    return response;
+}
+
+} // namespace solvers
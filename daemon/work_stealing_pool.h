@@ -0,0 +1,125 @@
+#pragma once
+
+// Fixed set of worker threads started once and kept warm for the daemon's lifetime.
+// Every worker owns a deque: it pops its own newest task (LIFO, cache-warm) and, when
+// empty, steals the oldest task of another worker. Tasks submitted from outside the
+// pool are spread round-robin over the deques.
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threadCount) : queues(threadCount) {
+        for (int i = 0; i < threadCount; i++) {
+            queues[i] = std::make_unique<Queue>();
+        }
+        for (int i = 0; i < threadCount; i++) {
+            workers.emplace_back([this, i]() { run(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            stopping = true;
+        }
+        idle.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int size() const {
+        return static_cast<int>(workers.size());
+    }
+
+    void submit(std::function<void()> task) {
+        int index = currentWorker >= 0 && currentOwner == this ? currentWorker
+                                                               : static_cast<int>(nextQueue++ % queues.size());
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            pending++;
+        }
+        idle.notify_one();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool popOwn(int index, std::function<void()>& task) {
+        Queue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int thief, std::function<void()>& task) {
+        for (size_t offset = 1; offset < queues.size(); offset++) {
+            Queue& queue = *queues[(thief + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(int index) {
+        currentWorker = index;
+        currentOwner = this;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(idleMutex);
+                idle.wait(lock, [this]() { return pending > 0 || stopping; });
+                if (pending == 0 && stopping) {
+                    return;
+                }
+                pending--;
+            }
+            // a task is reserved for this worker; it is in some deque
+            std::function<void()> task;
+            while (!popOwn(index, task) && !steal(index, task)) {
+                std::this_thread::yield();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> nextQueue{0};
+
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    long long pending = 0;
+    bool stopping = false;
+
+    static thread_local int currentWorker;
+    static thread_local WorkStealingPool* currentOwner;
+};
+
+inline thread_local int WorkStealingPool::currentWorker = -1;
+inline thread_local WorkStealingPool* WorkStealingPool::currentOwner = nullptr;
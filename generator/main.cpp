@@ -0,0 +1,241 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Taillard's portable generator (E. Taillard, "Benchmarks for basic scheduling problems", 1993):
+// X <- 16807 * X mod (2^31 - 1), unif(low, high) = low + floor(X / (2^31 - 1) * (high - low + 1))
+class TaillardRandom {
+public:
+    static const long long MODULUS = 2147483647;
+    static const long long MULTIPLIER = 16807;
+
+    explicit TaillardRandom(long long seed) : state(seed % MODULUS) {
+        if (state <= 0) {
+            state += MODULUS - 1;
+        }
+    }
+
+    int next(int low, int high) {
+        state = state * MULTIPLIER % MODULUS;
+        double value = static_cast<double>(state) / MODULUS;
+        return low + static_cast<int>(value * (high - low + 1));
+    }
+
+    // Jumps over `draws` values in O(log draws), so any cell of a generated matrix can be reached directly
+    void skip(long long draws) {
+        long long factor = MULTIPLIER;
+        long long jump = 1;
+        while (draws > 0) {
+            if (draws & 1) {
+                jump = jump * factor % MODULUS;
+            }
+            factor = factor * factor % MODULUS;
+            draws >>= 1;
+        }
+        state = state * jump % MODULUS;
+    }
+
+    long long seed() const {
+        return state;
+    }
+
+private:
+    long long state;
+};
+
+// Buffered writer so that instances with millions of rows stream through a fixed-size buffer
+class OutputStream {
+public:
+    explicit OutputStream(FILE* file) : file(file), used(0) {}
+
+    ~OutputStream() {
+        flush();
+    }
+
+    void write(const char* text) {
+        size_t length = strlen(text);
+        reserve(length);
+        memcpy(buffer + used, text, length);
+        used += length;
+    }
+
+    void write(long long value) {
+        reserve(24);
+        char digits[24];
+        int count = 0;
+        bool negative = value < 0;
+        unsigned long long magnitude = negative ? -static_cast<unsigned long long>(value) : value;
+        do {
+            digits[count++] = '0' + magnitude % 10;
+            magnitude /= 10;
+        } while (magnitude > 0);
+        if (negative) {
+            buffer[used++] = '-';
+        }
+        while (count > 0) {
+            buffer[used++] = digits[--count];
+        }
+    }
+
+    void flush() {
+        fwrite(buffer, 1, used, file);
+        used = 0;
+    }
+
+private:
+    void reserve(size_t length) {
+        if (used + length > sizeof(buffer)) {
+            flush();
+        }
+    }
+
+    FILE* file;
+    size_t used;
+    char buffer[1 << 16];
+};
+
+// Sum of `count` draws from U[low, high]; replays the stream instead of storing it
+long long sumOfDraws(long long seed, long long count, int low, int high) {
+    TaillardRandom random(seed);
+    long long sum = 0;
+    for (long long i = 0; i < count; i++) {
+        sum += random.next(low, high);
+    }
+    return sum;
+}
+
+// lab1 format: "n" followed by n lines "r p q" (LF line endings)
+void generateRPQ(OutputStream& out, long long numberOfTasks, long long seed) {
+    // p ~ U[1, 99]; r and q ~ U[1, sum p] so release and delivery windows scale with n
+    long long executionSum = sumOfDraws(seed, numberOfTasks, 1, 99);
+    int windowEnd = static_cast<int>(min<long long>(executionSum, 2147483646));
+    TaillardRandom executionRandom(seed);
+    TaillardRandom windowRandom(seed);
+    windowRandom.skip(numberOfTasks);
+
+    out.write(numberOfTasks);
+    out.write("\n");
+    for (long long i = 0; i < numberOfTasks; i++) {
+        int preparationTime = windowRandom.next(1, windowEnd);
+        int deliveryTime = windowRandom.next(1, windowEnd);
+        out.write(preparationTime);
+        out.write(" ");
+        out.write(executionRandom.next(1, 99));
+        out.write(" ");
+        out.write(deliveryTime);
+        out.write("\n");
+    }
+}
+
+// lab2 format: "data.ID:", n, n lines "p w d", then an "opt:" section; -1 marks an unknown optimum
+long long generateWiTi(OutputStream& out, int id, long long numberOfTasks, long long seed) {
+    // p ~ U[1, 99], w ~ U[1, 9], d ~ U[1, sum p]
+    long long executionSum = sumOfDraws(seed, numberOfTasks, 1, 99);
+    int dueDateEnd = static_cast<int>(min<long long>(executionSum, 2147483646));
+    TaillardRandom executionRandom(seed);
+    TaillardRandom weightRandom(seed);
+    weightRandom.skip(numberOfTasks);
+    TaillardRandom dueDateRandom(weightRandom.seed());
+    dueDateRandom.skip(numberOfTasks);
+
+    out.write("data.");
+    out.write(id);
+    out.write(":\r\n");
+    out.write(numberOfTasks);
+    out.write("\r\n");
+    for (long long i = 0; i < numberOfTasks; i++) {
+        out.write(executionRandom.next(1, 99));
+        out.write(" ");
+        out.write(weightRandom.next(1, 9));
+        out.write(" ");
+        out.write(dueDateRandom.next(1, dueDateEnd));
+        out.write("\r\n");
+    }
+    out.write("\r\nopt:\r\n-1\r\n\r\n\r\n");
+    return dueDateRandom.seed();
+}
+
+// lab3/lab4 format: "data.ID:", "n m", then one line of m processing times per job.
+// Values follow Taillard's machine-major draw order (p[machine][job] ~ U[1, 99]), so the
+// seeds of the original benchmark reproduce it exactly; one generator per machine is jumped
+// to the start of its row so that jobs can be written one at a time.
+long long generateFlowShop(OutputStream& out, int id, long long numberOfJobs, int numberOfMachines, long long seed) {
+    vector<TaillardRandom> machineRandom;
+    machineRandom.reserve(numberOfMachines);
+    for (int m = 0; m < numberOfMachines; m++) {
+        machineRandom.emplace_back(seed);
+        machineRandom.back().skip(m * numberOfJobs);
+    }
+
+    out.write("data.");
+    char label[16];
+    snprintf(label, sizeof(label), "%03d", id);
+    out.write(label);
+    out.write(":\r\n");
+    out.write(numberOfJobs);
+    out.write(" ");
+    out.write(numberOfMachines);
+    out.write("\r\n");
+    for (long long j = 0; j < numberOfJobs; j++) {
+        for (int m = 0; m < numberOfMachines; m++) {
+            if (m != 0) {
+                out.write(" ");
+            }
+            out.write(machineRandom[m].next(1, 99));
+        }
+        out.write("\r\n");
+    }
+    out.write("\r\n");
+    return machineRandom.back().seed();
+}
+
+void printUsage() {
+    cerr << "Usage:" << endl;
+    cerr << "  generator rpq <tasks> <seed>" << endl;
+    cerr << "  generator witi <tasks> <seed> [instances]" << endl;
+    cerr << "  generator flowshop <jobs> <machines> <seed> [instances]" << endl;
+    cerr << "Instances are written to standard output; with several instances each one" << endl;
+    cerr << "continues the random stream where the previous one stopped." << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    string problem = argv[1];
+    OutputStream out(stdout);
+
+    try {
+        if (problem == "rpq" && argc == 4) {
+            generateRPQ(out, stoll(argv[2]), stoll(argv[3]));
+        } else if (problem == "witi" && (argc == 4 || argc == 5)) {
+            long long numberOfTasks = stoll(argv[2]);
+            long long seed = stoll(argv[3]);
+            int instances = argc == 5 ? stoi(argv[4]) : 1;
+            for (int i = 0; i < instances; i++) {
+                seed = generateWiTi(out, i, numberOfTasks, seed);
+            }
+        } else if (problem == "flowshop" && (argc == 5 || argc == 6)) {
+            long long numberOfJobs = stoll(argv[2]);
+            int numberOfMachines = stoi(argv[3]);
+            long long seed = stoll(argv[4]);
+            int instances = argc == 6 ? stoi(argv[5]) : 1;
+            for (int i = 0; i < instances; i++) {
+                seed = generateFlowShop(out, i, numberOfJobs, numberOfMachines, seed);
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    } catch (const exception& error) {
+        cerr << "Invalid argument: " << error.what() << endl;
+        printUsage();
+        return 1;
+    }
+    return 0;
+}
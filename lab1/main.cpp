@@ -5,17 +5,23 @@
 #include <limits>
 #include <vector>
 #include <chrono>
+#include <climits>
+#include <iomanip>
 
-struct Task
-{
-    int id;
-    int preparationTime;
-    int executionTime;
-    int deliveryTime;
-};
+#include "../common/benchmark.h"
+#include "../common/instrumentation.h"
+#include "../common/metaheuristics.h"
+#include "../common/problems.h"
+#include "../common/rpq.h"
+
+using rpq::Task;
+using rpq::schrageSchedule;
+using rpq::calculateCmax;
+using rpq::getScheduledTasksSequence;
 
 Task* loadTasks(const std::string& filePath, int& numberOfTasks) 
 {
+    INSTRUMENT_PHASE(Parse);
     std::ifstream dataFile(filePath);
     if (!dataFile) 
     {
@@ -24,15 +30,7 @@ Task* loadTasks(const std::string& filePath, int& numberOfTasks)
         return nullptr;
     }
     
-    dataFile >> numberOfTasks; // Read the number of records
-    Task* tasks = new Task[numberOfTasks]; // Dynamically allocate array for tasks
-    
-    for (int i = 0; i < numberOfTasks; ++i) 
-    {
-        tasks[i].id = i+1;
-        dataFile >> tasks[i].preparationTime >> tasks[i].executionTime >> tasks[i].deliveryTime;
-    }
-    
+    Task* tasks = rpq::readTasks(dataFile, numberOfTasks);
     dataFile.close();
     return tasks;
 }
@@ -104,7 +102,10 @@ Task* insertLongestPrepTime(Task* tasks, int numberOfTasks) { //only for data2
     };
 
     // Sort tasks by preparation time
-    std::sort(tasksVec.begin(), tasksVec.end(), compareByPreparationTime);
+    {
+        INSTRUMENT_PHASE(Sort);
+        std::sort(tasksVec.begin(), tasksVec.end(), compareByPreparationTime);
+    }
 
     // Copy tasks sorted by preparation time into scheduledTasks
     for (const Task& task : tasksVec) {
@@ -149,69 +150,6 @@ Task* insertLongestPrepTime(Task* tasks, int numberOfTasks) { //only for data2
 
 
 
-Task* schrageSchedule(Task* tasks, int numberOfTasks) {
-    Task* scheduledTasks = new Task[numberOfTasks];
-    std::vector<Task> tasksVec(tasks, tasks + numberOfTasks);
-    std::vector<Task> readyQueue;
-    int currentTime = 0;
-    int scheduledCount = 0;
-
-    auto compareByDeliveryTime = [](const Task& a, const Task& b) {
-        return a.deliveryTime > b.deliveryTime; // Descending order for delivery time
-    };
-
-    auto compareByPreparationTime = [](const Task& a, const Task& b) {
-        return a.preparationTime < b.preparationTime; // Ascending order for preparation time
-    };
-
-    // Initial sort by preparation time to find the first task(s) to start
-    std::sort(tasksVec.begin(), tasksVec.end(), compareByPreparationTime);
-    
-    while (scheduledCount < numberOfTasks) {
-        // Move tasks ready to be processed to the ready queue
-        for (auto it = tasksVec.begin(); it != tasksVec.end();) {
-            if (it->preparationTime <= currentTime) {
-                readyQueue.push_back(*it);
-                it = tasksVec.erase(it); // Remove from tasksVec and add to readyQueue
-            } else {
-                ++it;
-            }
-        }
-
-        // If ready queue is empty, advance time to the next task's preparation time
-        if (readyQueue.empty() && !tasksVec.empty()) {
-            currentTime = tasksVec.front().preparationTime;
-            continue;
-        }
-
-        // Sort ready queue by delivery time to select the task with the highest delivery time
-        std::sort(readyQueue.begin(), readyQueue.end(), compareByDeliveryTime);
-        Task selectedTask = readyQueue.front();
-        readyQueue.erase(readyQueue.begin());
-
-        // "Process" selected task
-        scheduledTasks[scheduledCount++] = selectedTask;
-        currentTime += selectedTask.executionTime;
-    }
-
-    return scheduledTasks;
-}
-
-std::string getScheduledTasksSequence(const Task* scheduledTasks, int numberOfTasks) 
-{
-    std::string solution = "";
-    for (int i = 0; i < numberOfTasks; ++i) 
-    {
-        solution += std::to_string(scheduledTasks[i].id);
-        if (i < numberOfTasks - 1) 
-        {
-            solution += " ";
-        }
-    }
-    return solution;
-}
-
-
 void printExecutionTime(std::chrono::milliseconds duration)
 {
     auto milliseconds = duration.count();
@@ -222,23 +160,6 @@ void printExecutionTime(std::chrono::milliseconds duration)
     std::cout << "\nExecution time: " << seconds << " seconds " << milliseconds << " milliseconds" << std::endl;
 }
 
-int calculateCmax(const Task* scheduledTasks, int numberOfTasks) {
-    int currentTime = 0;
-    int cmax = 0;
-
-    for (int i = 0; i < numberOfTasks; ++i) {
-        const Task& task = scheduledTasks[i];
-        
-        int startTime = std::max(currentTime, task.preparationTime);
-        int finishTime = startTime + task.executionTime + task.deliveryTime;
-        currentTime = startTime + task.executionTime;
-        
-        cmax = std::max(cmax, finishTime);
-    }
-
-    return cmax;
-}
-
 std::string getTotalCmax(int* cmaxData, int dataFilesCount) 
 {
     int totalCmax = 0;
@@ -249,13 +170,101 @@ std::string getTotalCmax(int* cmaxData, int dataFilesCount)
     return std::to_string(totalCmax);
 }
 
-int main() 
+int runBenchmark(const benchmark::Options& options, const Data* data, int dataFilesCount) 
+{
+    benchmark::Suite suite(options);
+    for (int i = 0; i < dataFilesCount; ++i) 
+    {
+        std::string size = std::to_string(data[i].numberOfTasks) + "/data" + std::to_string(i+1);
+        suite.measure("Schrage", size, [&]() 
+        {
+            Task* scheduledTasks = schrageSchedule(data[i].tasks, data[i].numberOfTasks);
+            benchmark::keep(calculateCmax(scheduledTasks, data[i].numberOfTasks));
+            delete[] scheduledTasks;
+        });
+    }
+    return suite.finish();
+}
+
+// Annealing, iterated local search and tabu search from the Schrage order on every data
+// file; each reported Cmax is recomputed from its order
+int runMetaheuristics(const Data* data, int dataFilesCount) 
+{
+    const char* names[] = {"Annealing", "ILS", "Tabu"};
+    long long evaluations[3] = {};
+    double seconds[3] = {};
+    int totals[3] = {};
+    int mismatches = 0;
+    std::cout << std::fixed << std::setprecision(0);
+    for (int i = 0; i < dataFilesCount; ++i) 
+    {
+        int n = data[i].numberOfTasks;
+        Task* schrage = schrageSchedule(data[i].tasks, n);
+        std::vector<int> start(n);
+        for (int k = 0; k < n; ++k) 
+        {
+            start[k] = schrage[k].id - 1; // ids are assigned from 1
+        }
+        std::cout << "data" << i + 1 << ": Schrage: " << calculateCmax(schrage, n);
+        delete[] schrage;
+
+        meta::RpqProblem problem(data[i].tasks, n, start);
+        for (int a = 0; a < 3; ++a) 
+        {
+            Random random(static_cast<unsigned int>(i));
+            problem.assign(start);
+            meta::Result result = a == 0 ? meta::anneal(problem, meta::AnnealingSettings(), random) 
+                                : a == 1 ? meta::iteratedLocalSearch(problem, meta::LocalSearchSettings(), random) 
+                                         : meta::tabuSearch(problem, meta::TabuSettings());
+            std::vector<Task> ordered(n);
+            for (int k = 0; k < n; ++k) 
+            {
+                ordered[k] = data[i].tasks[result.order[k]];
+            }
+            int cmax = calculateCmax(ordered.data(), n);
+            if (cmax != result.cost || problem.cost() != result.cost) 
+            {
+                std::cout << " MISMATCH (" << names[a] << " reported " << result.cost << ", actual " << cmax << ")";
+                mismatches++;
+            }
+            std::cout << " | " << names[a] << ": " << cmax;
+            evaluations[a] += result.evaluations;
+            seconds[a] += result.seconds;
+            totals[a] += cmax;
+        }
+        std::cout << std::endl;
+    }
+    for (int a = 0; a < 3; ++a) 
+    {
+        std::cout << std::left << std::setw(10) << names[a] << std::right << " Total Cmax: " << totals[a]
+                  << " | evaluations/s: " << evaluations[a] / seconds[a] << std::endl;
+    }
+    std::cout << "Mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) 
 {
     auto start = std::chrono::high_resolution_clock::now();
 
     const int DATA_FILES_COUNT = 4;
     const std::string DATA_DIR_PATH = "data/";
     Data* data = loadDataFiles(DATA_DIR_PATH, DATA_FILES_COUNT);
+
+    benchmark::Options benchmarkOptions = benchmark::parseOptions(argc, argv);
+    if (benchmarkOptions.enabled) 
+    {
+        return runBenchmark(benchmarkOptions, data, DATA_FILES_COUNT);
+    }
+    for (int i = 1; i < argc; ++i) 
+    {
+        if (std::string(argv[i]) == "--metaheuristics") 
+        {
+            return runMetaheuristics(data, DATA_FILES_COUNT);
+        }
+    }
+    INSTRUMENT_REPORT(std::cout, "load");
+
     int* cmaxData = new int[DATA_FILES_COUNT];
     for (int i = 0; i<DATA_FILES_COUNT; i++)
     {
@@ -269,8 +278,10 @@ int main()
         auto cmax = calculateCmax(scheduledTasks, data[i].numberOfTasks);
         cmaxData[i] = cmax;
         std::cout << "Cmax = " << cmax << std::endl;
+        INSTRUMENT_REPORT(std::cout, "data" + std::to_string(i+1));
     }
     std::cout << "\nTotal Cmax: " << getTotalCmax(cmaxData, DATA_FILES_COUNT) << std::endl;
+    INSTRUMENT_SUMMARY(std::cout);
     
     auto stop = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
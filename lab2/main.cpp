@@ -5,20 +5,21 @@
 #include <chrono>
 #include <sstream>
 #include <vector>
-
-struct Task
-{
-    int id;
-    int executionTime;
-    int penaltyWeight;
-    int completionTime;
-};
-
-struct Result
-{
-    int time;
-    std::string taskSequence;
-};
+#include <algorithm>
+#include <climits>
+#include <iomanip>
+
+#include "../common/benchmark.h"
+#include "../common/instrumentation.h"
+#include "../common/metaheuristics.h"
+#include "../common/problems.h"
+#include "../common/witi.h"
+
+using witi::Task;
+using witi::Result;
+using witi::readTask;
+using witi::scheduleTasks;
+using witi::scheduleTasksSparse;
 
 struct Data
 {
@@ -28,7 +29,6 @@ struct Data
     Result optimalResult;
 };
 
-Task readTask(std::istream& in);
 Result readOptimalResult(std::istream& in);
 Data createDataset(std::istream& in, int id, int numberOfTasks);
 
@@ -65,6 +65,7 @@ void printResult(const Result& result)
 
 std::list<Data>* loadDataFile(std::string filePath) 
 {
+    INSTRUMENT_PHASE(Parse);
     std::list<Data>* datasets = new std::list<Data>();
     std::ifstream dataFile(filePath);
     std::string line;
@@ -84,14 +85,6 @@ std::list<Data>* loadDataFile(std::string filePath)
     return datasets;
 }
 
-// Reads and returns a single task from the input stream
-Task readTask(std::istream& in) 
-{
-    Task task;
-    in >> task.executionTime >> task.penaltyWeight >> task.completionTime;
-    return task;
-}
-
 Result readOptimalResult(std::istream& in) 
 {
     Result result;
@@ -155,81 +148,155 @@ int calculateTotalPenalty(const Data& dataset)
     return totalPenalty;
 }
 
-Result scheduleTasks(const Task* tasks, int numberOfTasks) 
+int runBenchmark(const benchmark::Options& options, const std::list<Data>& datasets) 
 {
-    // Convert array to vector for easier manipulation
-    std::vector<Task> taskVector(tasks, tasks + numberOfTasks);
-    
-    // Sort tasks based on a heuristic, smallest penalty weight or other criteria could be considered
-    std::sort(taskVector.begin(), taskVector.end(), [](const Task& a, const Task& b) 
+    benchmark::Suite suite(options);
+    for (const auto& dataset : datasets) 
     {
-        return a.completionTime < b.completionTime; // Earliest due date first
-    });
-
-    int n = taskVector.size();
-    std::vector<int> dp(1 << n, INT_MAX); // DP array to store minimum penalty for each subset of tasks
-    dp[0] = 0; // Base case: no tasks scheduled, no penalty
-    std::vector<int> lastTask(1 << n, -1); // To track the last task in optimal sequence
+        suite.measure("WiTi DP", std::to_string(dataset.numberOfTasks), [&]() 
+        {
+            benchmark::keep(scheduleTasks(dataset.tasks, dataset.numberOfTasks));
+        });
+        suite.measure("WiTi sparse DP", std::to_string(dataset.numberOfTasks), [&]() 
+        {
+            benchmark::keep(scheduleTasksSparse(dataset.tasks, dataset.numberOfTasks));
+        });
+    }
+    return suite.finish();
+}
 
-    // Iterate over each subset of tasks
-    for (int mask = 0; mask < (1 << n); ++mask) 
+// Dense against sparse DP per dataset: time, memory and agreement of the optimum. The
+// dense tables hold 2^n entries, so it is skipped above 24 tasks.
+int runSparseComparison(const std::list<Data>& datasets) 
+{
+    const int denseLimit = 24;
+    int mismatches = 0;
+    std::cout << std::left << std::setw(10) << "dataset" << std::right << std::setw(4) << "n" << std::setw(8) << "arcs"
+              << std::setw(12) << "states" << std::setw(12) << "dense ms" << std::setw(12) << "dense MB"
+              << std::setw(12) << "sparse ms" << std::setw(12) << "sparse MB" << std::setw(12) << "WiTi" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& dataset : datasets) 
     {
-        if (dp[mask] == INT_MAX) continue; // Skip infeasible states
+        int n = dataset.numberOfTasks;
+        witi::SparseStats stats;
+        auto start = std::chrono::steady_clock::now();
+        Result sparse = scheduleTasksSparse(dataset.tasks, n, &stats);
+        double sparseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::left << std::setw(10) << ("data." + std::to_string(dataset.id)) << std::right << std::setw(4) << n
+                  << std::setw(8) << stats.precedences << std::setw(12) << stats.states;
+        int expected = dataset.optimalResult.time;
+        if (n <= denseLimit) 
+        {
+            start = std::chrono::steady_clock::now();
+            Result dense = scheduleTasks(dataset.tasks, n);
+            double denseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            double denseMb = (2.0 * sizeof(int) * (1LL << n)) / (1 << 20);
+            std::cout << std::setw(12) << denseMs << std::setw(12) << denseMb;
+            expected = dense.time;
+        } 
+        else 
+        {
+            std::cout << std::setw(12) << "-" << std::setw(12) << "-";
+        }
+        std::cout << std::setw(12) << sparseMs << std::setw(12) << stats.peakBytes / double(1 << 20) << std::setw(12)
+                  << sparse.time;
+        if (expected >= 0 && sparse.time != expected) 
+        {
+            std::cout << " MISMATCH (expected " << expected << ")";
+            mismatches++;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
 
-        int currentTime = 0; // Current time is the sum of execution times of tasks in the current subset
-        for (int i = 0; i < n; ++i) 
+// Annealing, iterated local search and tabu search from the EDD order on every dataset;
+// each reported penalty is recomputed from its order
+int runMetaheuristics(const std::list<Data>& datasets) 
+{
+    const char* names[] = {"Annealing", "ILS", "Tabu"};
+    long long evaluations[3] = {};
+    double seconds[3] = {};
+    long long totals[3] = {};
+    int mismatches = 0;
+    std::cout << std::fixed << std::setprecision(0);
+    for (const auto& dataset : datasets) 
+    {
+        int n = dataset.numberOfTasks;
+        std::vector<int> start(n);
+        for (int k = 0; k < n; ++k) 
         {
-            if (mask & (1 << i)) 
-            {
-                currentTime += taskVector[i].executionTime;
-            }
+            start[k] = k;
         }
+        std::stable_sort(start.begin(), start.end(), [&](int a, int b) 
+        {
+            return dataset.tasks[a].completionTime < dataset.tasks[b].completionTime;
+        });
 
-        // Consider adding each task not yet in the subset
-        for (int i = 0; i < n; ++i) 
+        meta::WitiProblem problem(dataset.tasks, n, start);
+        std::cout << "data." << dataset.id << ": EDD: " << problem.cost();
+        for (int a = 0; a < 3; ++a) 
         {
-            if (!(mask & (1 << i))) 
+            Random random(static_cast<unsigned int>(dataset.id));
+            problem.assign(start);
+            meta::Result result = a == 0 ? meta::anneal(problem, meta::AnnealingSettings(), random) 
+                                : a == 1 ? meta::iteratedLocalSearch(problem, meta::LocalSearchSettings(), random) 
+                                         : meta::tabuSearch(problem, meta::TabuSettings());
+            long long time = 0;
+            long long penalty = 0;
+            for (int job : result.order) 
             {
-                int nextMask = mask | (1 << i);
-                int finishTime = currentTime + taskVector[i].executionTime;
-                int tardiness = std::max(0, finishTime - taskVector[i].completionTime);
-                int penalty = tardiness * taskVector[i].penaltyWeight;
-
-                if (dp[nextMask] > dp[mask] + penalty) {
-                    dp[nextMask] = dp[mask] + penalty;
-                    lastTask[nextMask] = i;
-                }
+                time += dataset.tasks[job].executionTime;
+                penalty += std::max<long long>(0, time - dataset.tasks[job].completionTime) * dataset.tasks[job].penaltyWeight;
             }
+            if (penalty != result.cost || problem.cost() != result.cost) 
+            {
+                std::cout << " MISMATCH (" << names[a] << " reported " << result.cost << ", actual " << penalty << ")";
+                mismatches++;
+            }
+            std::cout << " | " << names[a] << ": " << penalty;
+            evaluations[a] += result.evaluations;
+            seconds[a] += result.seconds;
+            totals[a] += penalty;
         }
+        std::cout << " | optimum: " << dataset.optimalResult.time << std::endl;
     }
-
-    // Reconstruct the optimal task sequence using `lastTask`
-    std::vector<int> sequence;
-    int currentMask = (1 << n) - 1;
-    while (currentMask) 
-    {
-        int taskIdx = lastTask[currentMask];
-        sequence.push_back(taskVector[taskIdx].id);
-        currentMask &= ~(1 << taskIdx); // Remove the last task added from currentMask
-    }
-    std::reverse(sequence.begin(), sequence.end()); // Reverse to get the order from start to finish
-
-    // Convert task sequence to string
-    std::stringstream ss;
-    for (int id : sequence) 
+    for (int a = 0; a < 3; ++a) 
     {
-        ss << id << " ";
+        std::cout << std::left << std::setw(10) << names[a] << std::right << " Total WiTi: " << totals[a]
+                  << " | evaluations/s: " << evaluations[a] / seconds[a] << std::endl;
     }
-
-    return {dp[(1 << n) - 1], ss.str().substr(0, ss.str().size() - 1)}; // Remove the last space
+    std::cout << "Mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
 }
 
-int main() 
+int main(int argc, char* argv[]) 
 {
     auto start = std::chrono::high_resolution_clock::now();
 
     const std::string DATA_PATH = "data.txt";
     std::list<Data> datasets = *loadDataFile(DATA_PATH);
+
+    benchmark::Options benchmarkOptions = benchmark::parseOptions(argc, argv);
+    if (benchmarkOptions.enabled) 
+    {
+        return runBenchmark(benchmarkOptions, datasets);
+    }
+    for (int i = 1; i < argc; ++i) 
+    {
+        if (std::string(argv[i]) == "--sparse") 
+        {
+            // optionally on another file in the same format, e.g. generator witi 35 <seed> 5
+            return runSparseComparison(i + 1 < argc ? *loadDataFile(argv[i + 1]) : datasets);
+        }
+        if (std::string(argv[i]) == "--metaheuristics") 
+        {
+            return runMetaheuristics(datasets);
+        }
+    }
+    INSTRUMENT_REPORT(std::cout, "load");
     
     for (auto& dataset : datasets) 
     {
@@ -242,7 +309,9 @@ int main()
         std::cout << "Received ";
         Result result = scheduleTasks(dataset.tasks, dataset.numberOfTasks);
         printResult(result);
+        INSTRUMENT_REPORT(std::cout, "data." + std::to_string(dataset.id));
     }
+    INSTRUMENT_SUMMARY(std::cout);
     
     auto stop = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
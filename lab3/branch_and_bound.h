@@ -0,0 +1,333 @@
+#pragma once
+
+// Exact branch-and-bound for small permutation flow-shop instances (n <= 64).
+//
+// Jobs are appended to a prefix in depth-first order. A node is just (depth, bitmask of
+// scheduled jobs); its completion-time row, remaining per-machine work and candidate
+// children live in per-depth slices of buffers allocated once per worker. Bounds:
+//  - machine bound: C_k + remaining work on k + smallest tail after k, maximised over k
+//  - two-machine Johnson bound with time lags for every machine pair (k, l), evaluated
+//    only when the machine bound does not prune
+// The NEH makespan seeds the incumbent, which threads share through an atomic. Subtrees
+// rooted at every two-job prefix are handed out to a pool of threads.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../common/flowshop.h"
+
+struct BranchAndBoundResult {
+    std::vector<int> order;
+    int cmax = 0;
+    int rootBound = 0;
+    bool proven = false; // false when the time limit stopped the search
+    long long nodes = 0;
+    double seconds = 0;
+};
+
+class BranchAndBound {
+public:
+    BranchAndBound(const flowshop::InstanceView& instance, double timeLimitSeconds, int threadCount = 0)
+        : instance(instance), jobCount(instance.jobCount), machineCount(instance.machineCount),
+          timeLimit(timeLimitSeconds), threadCount(threadCount) {
+        if (this->threadCount <= 0) {
+            this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        // sum of a job's processing times on the machines after k
+        tailAfter.assign(static_cast<size_t>(jobCount) * machineCount, 0);
+        for (int j = 0; j < jobCount; j++) {
+            const int* durations = instance.job(j);
+            int sum = 0;
+            for (int k = machineCount - 1; k >= 0; k--) {
+                tailAfter[static_cast<size_t>(j) * machineCount + k] = sum;
+                sum += durations[k];
+            }
+        }
+        // Mitten's rule: Johnson's order on (p_k + lag, p_l + lag) is optimal for the two-machine relaxation
+        for (int k = 0; k < machineCount; k++) {
+            for (int l = k + 1; l < machineCount; l++) {
+                Pair pair;
+                pair.first = k;
+                pair.second = l;
+                pair.lags.resize(jobCount);
+                pair.order.resize(jobCount);
+                for (int j = 0; j < jobCount; j++) {
+                    const int* durations = instance.job(j);
+                    int lag = 0;
+                    for (int h = k + 1; h < l; h++) {
+                        lag += durations[h];
+                    }
+                    pair.lags[j] = lag;
+                    pair.order[j] = j;
+                }
+                std::sort(pair.order.begin(), pair.order.end(), [&](int a, int b) {
+                    int a1 = instance.job(a)[k] + pair.lags[a];
+                    int a2 = instance.job(a)[l] + pair.lags[a];
+                    int b1 = instance.job(b)[k] + pair.lags[b];
+                    int b2 = instance.job(b)[l] + pair.lags[b];
+                    bool aFirst = a1 < a2;
+                    bool bFirst = b1 < b2;
+                    if (aFirst != bFirst) {
+                        return aFirst;
+                    }
+                    return aFirst ? a1 < b1 : a2 > b2;
+                });
+                pairs.push_back(std::move(pair));
+            }
+        }
+    }
+
+    BranchAndBoundResult solve() {
+        BranchAndBoundResult result;
+        if (jobCount == 0 || jobCount > 64) {
+            return result;
+        }
+        start = std::chrono::steady_clock::now();
+        stopped = false;
+        bestOrder = flowshop::optimizedNEH(instance);
+        incumbent = flowshop::makespan(instance, bestOrder);
+
+        // the root bound, and every two-job prefix as an independent subtree ordered by its bound
+        Worker root(*this);
+        result.rootBound = root.bound(0, 0, INT_MAX);
+        std::vector<Subtree> subtrees;
+        for (int a = 0; a < jobCount; a++) {
+            for (int b = 0; b < jobCount; b++) {
+                if (a != b) {
+                    subtrees.push_back({a, b, root.prefixBound(a, b)});
+                }
+            }
+        }
+        if (jobCount == 1) {
+            subtrees.push_back({0, -1, 0});
+        }
+        std::sort(subtrees.begin(), subtrees.end(), [](const Subtree& x, const Subtree& y) {
+            return x.bound < y.bound;
+        });
+
+        std::atomic<size_t> next(0);
+        std::atomic<long long> totalNodes(0);
+        auto work = [&]() {
+            Worker worker(*this);
+            size_t index;
+            while (!stopped && (index = next++) < subtrees.size()) {
+                if (subtrees[index].bound >= incumbent.load()) {
+                    continue;
+                }
+                worker.explore(subtrees[index]);
+            }
+            totalNodes += worker.nodes;
+        };
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; t++) {
+            threads.emplace_back(work);
+        }
+        work();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        result.order = bestOrder;
+        result.cmax = incumbent;
+        result.proven = !stopped;
+        result.nodes = totalNodes;
+        result.seconds = elapsed();
+        return result;
+    }
+
+private:
+    struct Pair {
+        int first;
+        int second;
+        std::vector<int> lags;
+        std::vector<int> order;
+    };
+
+    struct Subtree {
+        int first;
+        int second;
+        int bound;
+    };
+
+    class Worker {
+    public:
+        explicit Worker(BranchAndBound& owner)
+            : owner(owner), n(owner.jobCount), m(owner.machineCount),
+              heads(static_cast<size_t>(n + 1) * m, 0), remaining(static_cast<size_t>(n + 1) * m, 0),
+              children(static_cast<size_t>(n + 1) * n), order(n) {
+            for (int j = 0; j < n; j++) {
+                const int* durations = owner.instance.job(j);
+                for (int k = 0; k < m; k++) {
+                    remaining[k] += durations[k];
+                }
+            }
+        }
+
+        void explore(const Subtree& subtree) {
+            push(0, subtree.first);
+            uint64_t mask = uint64_t(1) << subtree.first;
+            if (subtree.second >= 0) {
+                push(1, subtree.second);
+                mask |= uint64_t(1) << subtree.second;
+                search(2, mask);
+            } else {
+                search(1, mask);
+            }
+        }
+
+        // Lower bound of the node at `depth` whose scheduled jobs are `mask`; stops early once it reaches `cutoff`
+        int bound(int depth, uint64_t mask, int cutoff) const {
+            const int* row = &heads[static_cast<size_t>(depth) * m];
+            const int* work = &remaining[static_cast<size_t>(depth) * m];
+            int lowerBound = 0;
+            for (int k = 0; k < m; k++) {
+                int minTail = INT_MAX;
+                for (int j = 0; j < n; j++) {
+                    if (!(mask >> j & 1)) {
+                        minTail = std::min(minTail, owner.tailAfter[static_cast<size_t>(j) * m + k]);
+                    }
+                }
+                if (minTail == INT_MAX) {
+                    minTail = 0;
+                }
+                lowerBound = std::max(lowerBound, row[k] + work[k] + minTail);
+            }
+            if (lowerBound >= cutoff) {
+                return lowerBound;
+            }
+            for (const Pair& pair : owner.pairs) {
+                int k = pair.first;
+                int l = pair.second;
+                int first = row[k];
+                int second = row[l];
+                int minTail = INT_MAX;
+                for (int j : pair.order) {
+                    if (mask >> j & 1) {
+                        continue;
+                    }
+                    const int* durations = owner.instance.job(j);
+                    first += durations[k];
+                    second = std::max(second, first + pair.lags[j]) + durations[l];
+                    minTail = std::min(minTail, owner.tailAfter[static_cast<size_t>(j) * m + l]);
+                }
+                if (minTail == INT_MAX) {
+                    minTail = 0;
+                }
+                lowerBound = std::max(lowerBound, second + minTail);
+                if (lowerBound >= cutoff) {
+                    break;
+                }
+            }
+            return lowerBound;
+        }
+
+        int prefixBound(int a, int b) {
+            push(0, a);
+            if (b < 0) {
+                return bound(1, uint64_t(1) << a, INT_MAX);
+            }
+            push(1, b);
+            return bound(2, (uint64_t(1) << a) | (uint64_t(1) << b), INT_MAX);
+        }
+
+        long long nodes = 0;
+
+    private:
+        // Appends `job` at position `depth`, filling row depth + 1 of heads and remaining
+        void push(int depth, int job) {
+            const int* durations = owner.instance.job(job);
+            const int* previous = &heads[static_cast<size_t>(depth) * m];
+            int* current = &heads[static_cast<size_t>(depth + 1) * m];
+            const int* work = &remaining[static_cast<size_t>(depth) * m];
+            int* nextWork = &remaining[static_cast<size_t>(depth + 1) * m];
+            int time = 0;
+            for (int k = 0; k < m; k++) {
+                time = std::max(time, previous[k]) + durations[k];
+                current[k] = time;
+                nextWork[k] = work[k] - durations[k];
+            }
+            order[depth] = job;
+        }
+
+        void search(int depth, uint64_t mask) {
+            nodes++;
+            if ((nodes & 4095) == 0 && owner.elapsed() > owner.timeLimit) {
+                owner.stopped = true;
+            }
+            if (owner.stopped) {
+                return;
+            }
+            if (depth == n) {
+                owner.offer(heads[static_cast<size_t>(n) * m + m - 1], order);
+                return;
+            }
+
+            // score every child, then visit them in increasing bound order
+            std::pair<int, int>* candidates = &children[static_cast<size_t>(depth) * n];
+            int count = 0;
+            for (int j = 0; j < n; j++) {
+                if (mask >> j & 1) {
+                    continue;
+                }
+                push(depth, j);
+                int childBound = bound(depth + 1, mask | uint64_t(1) << j, owner.incumbent.load(std::memory_order_relaxed));
+                if (childBound < owner.incumbent.load(std::memory_order_relaxed)) {
+                    candidates[count++] = {childBound, j};
+                }
+            }
+            std::sort(candidates, candidates + count);
+            for (int c = 0; c < count; c++) {
+                if (candidates[c].first >= owner.incumbent.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                push(depth, candidates[c].second);
+                search(depth + 1, mask | uint64_t(1) << candidates[c].second);
+            }
+        }
+
+        BranchAndBound& owner;
+        int n;
+        int m;
+        std::vector<int> heads;
+        std::vector<int> remaining;
+        std::vector<std::pair<int, int>> children;
+        std::vector<int> order;
+    };
+
+    void offer(int cmax, const std::vector<int>& order) {
+        int current = incumbent.load();
+        while (cmax < current) {
+            if (incumbent.compare_exchange_weak(current, cmax)) {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                if (cmax <= flowshop::makespan(instance, bestOrder)) {
+                    bestOrder = order;
+                }
+                return;
+            }
+        }
+    }
+
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    flowshop::InstanceView instance;
+    int jobCount;
+    int machineCount;
+    double timeLimit;
+    int threadCount;
+    std::vector<int> tailAfter;
+    std::vector<Pair> pairs;
+
+    std::atomic<int> incumbent{INT_MAX};
+    std::atomic<bool> stopped{false};
+    std::mutex orderMutex;
+    std::vector<int> bestOrder;
+    std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+// NEH for very large instances (10k+ jobs), where the flat head and tail matrices of
+// optimizedNEH outgrow the caches and every insertion step streams them from memory.
+//
+// The sequence is a list of chunks of at most 2 * chunkJobs jobs. Each chunk stores, in
+// sequence order, its jobs, their processing times (copied in, 16-bit when the instance
+// allows) and their tail rows, so both passes of a step walk memory strictly forward
+// or backward through one small tile at a time, and inserting a job only shifts
+// rows inside one chunk. Per step:
+//  - one forward pass carries the head row in registers, scores the insertion at every
+//    position against that position's tail row, and advances the head row through the
+//    job; heads are never stored, recomputing them from the compact times is cheaper
+//    than reading a stored matrix
+//  - after the insertion only tail rows in front of it are recomputed; the rows behind
+//    it keep their values and, living in their own chunks, need no shifting
+// Ties are broken toward the earliest position, so the result equals optimizedNEH.
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "../common/flowshop.h"
+
+struct LargeNEHStats {
+    long long rowsEvaluated = 0; // positions scored by the forward passes
+    long long tailRowsUpdated = 0;
+    size_t storageBytes = 0; // chunk storage at the end: jobs, times and tails
+    bool compactTimes = false;
+
+    // Bytes the passes stream: each scored position reads a times row and a tail row;
+    // each updated tail row reads a times row and the next tail row and writes itself
+    double trafficBytes(int machineCount) const {
+        double timesRow = static_cast<double>(machineCount) * (compactTimes ? 2 : 4);
+        double tailRow = static_cast<double>(machineCount) * 4;
+        return rowsEvaluated * (timesRow + tailRow) + tailRowsUpdated * (timesRow + 2 * tailRow);
+    }
+};
+
+namespace large {
+
+constexpr int chunkJobs = 128;
+
+template <typename Time, int M>
+class ChunkedNEH {
+public:
+    ChunkedNEH(const flowshop::Instance& instance, LargeNEHStats& stats)
+        : instance(instance), machineCount(flowshop::kernels::machines<M>(instance)), stats(stats),
+          head(machineCount), durations(machineCount) {}
+
+    std::vector<int> run(const std::vector<int>& initialOrder) {
+        for (int job : initialOrder) {
+            insert(job);
+        }
+        std::vector<int> order;
+        order.reserve(initialOrder.size());
+        size_t bytes = 0;
+        for (const Chunk& chunk : chunks) {
+            order.insert(order.end(), chunk.jobs.begin(), chunk.jobs.end());
+            bytes += chunk.jobs.capacity() * sizeof(int) + chunk.times.capacity() * sizeof(Time) +
+                     chunk.tails.capacity() * sizeof(int);
+        }
+        stats.storageBytes = bytes;
+        return order;
+    }
+
+private:
+    struct Chunk {
+        std::vector<int> jobs;
+        std::vector<Time> times; // row i holds the processing times of jobs[i]
+        std::vector<int> tails;  // row i: tail of position i of this chunk
+    };
+
+    void insert(int job) {
+        const int m = machineCount;
+        const int* source = instance.job(job);
+        std::copy(source, source + m, durations.begin());
+
+        // forward pass: score position (c, i) with the head row in front of it
+        std::fill(head.begin(), head.end(), 0);
+        int minCmax = INT_MAX;
+        size_t bestChunk = 0;
+        int bestIndex = 0;
+        for (size_t c = 0; c < chunks.size(); c++) {
+            const Chunk& chunk = chunks[c];
+            const int count = static_cast<int>(chunk.jobs.size());
+            for (int i = 0; i < count; i++) {
+                const int* tail = &chunk.tails[static_cast<size_t>(i) * m];
+                const Time* times = &chunk.times[static_cast<size_t>(i) * m];
+                int time = 0;
+                int cmax = 0;
+                int next = 0;
+                FLOWSHOP_UNROLL
+                for (int k = 0; k < m; k++) {
+                    int previous = head[k];
+                    time = std::max(time, previous) + durations[k];
+                    cmax = std::max(cmax, time + tail[k]);
+                    next = std::max(next, previous) + times[k];
+                    head[k] = next;
+                }
+                if (cmax < minCmax) {
+                    minCmax = cmax;
+                    bestChunk = c;
+                    bestIndex = i;
+                }
+            }
+            stats.rowsEvaluated += count;
+        }
+        // the end of the sequence, where the tail is empty
+        int time = 0;
+        for (int k = 0; k < m; k++) {
+            time = std::max(time, head[k]) + durations[k];
+        }
+        if (time < minCmax) {
+            if (chunks.empty()) {
+                chunks.emplace_back();
+            }
+            bestChunk = chunks.size() - 1;
+            bestIndex = static_cast<int>(chunks.back().jobs.size());
+        }
+
+        // insert into the chunk, splitting it once it holds 2 * chunkJobs jobs
+        Chunk& chunk = chunks[bestChunk];
+        chunk.jobs.insert(chunk.jobs.begin() + bestIndex, job);
+        chunk.times.insert(chunk.times.begin() + static_cast<size_t>(bestIndex) * m, durations.begin(), durations.end());
+        chunk.tails.insert(chunk.tails.begin() + static_cast<size_t>(bestIndex) * m, m, 0);
+        if (static_cast<int>(chunk.jobs.size()) >= 2 * chunkJobs) {
+            split(bestChunk);
+            if (bestIndex >= chunkJobs) {
+                bestChunk++;
+                bestIndex -= chunkJobs;
+            }
+        }
+        updateTails(bestChunk, bestIndex);
+    }
+
+    void split(size_t c) {
+        Chunk upper;
+        Chunk& lower = chunks[c];
+        const size_t rows = static_cast<size_t>(chunkJobs) * machineCount;
+        upper.jobs.assign(lower.jobs.begin() + chunkJobs, lower.jobs.end());
+        upper.times.assign(lower.times.begin() + rows, lower.times.end());
+        upper.tails.assign(lower.tails.begin() + rows, lower.tails.end());
+        lower.jobs.resize(chunkJobs);
+        lower.times.resize(rows);
+        lower.tails.resize(rows);
+        chunks.insert(chunks.begin() + c + 1, std::move(upper));
+    }
+
+    // Recomputes tail rows from (c, i) back to the first position
+    void updateTails(size_t c, int i) {
+        const int m = machineCount;
+        const int* next = c + 1 < chunks.size() ? chunks[c + 1].tails.data() : nullptr;
+        if (i + 1 < static_cast<int>(chunks[c].jobs.size())) {
+            next = &chunks[c].tails[static_cast<size_t>(i + 1) * m];
+        }
+        for (size_t chunkIndex = c + 1; chunkIndex-- > 0;) {
+            Chunk& chunk = chunks[chunkIndex];
+            int first = chunkIndex == c ? i : static_cast<int>(chunk.jobs.size()) - 1;
+            for (int row = first; row >= 0; row--) {
+                int* current = &chunk.tails[static_cast<size_t>(row) * m];
+                const Time* times = &chunk.times[static_cast<size_t>(row) * m];
+                int time = 0;
+                if (next == nullptr) {
+                    for (int k = m - 1; k >= 0; k--) {
+                        time += times[k];
+                        current[k] = time;
+                    }
+                } else {
+                    FLOWSHOP_UNROLL
+                    for (int k = m - 1; k >= 0; k--) {
+                        time = std::max(time, next[k]) + times[k];
+                        current[k] = time;
+                    }
+                }
+                next = current;
+            }
+            stats.tailRowsUpdated += first + 1;
+        }
+    }
+
+    const flowshop::Instance& instance;
+    const int machineCount;
+    LargeNEHStats& stats;
+    std::vector<Chunk> chunks;
+    std::vector<int> head;
+    std::vector<int> durations;
+};
+
+} // namespace large
+
+// Large-instance NEH; times are kept as 16 bits when every value fits and `allowCompact`
+inline std::vector<int> largeNEH(const flowshop::Instance& instance, bool allowCompact = true,
+                                 LargeNEHStats* stats = nullptr) {
+    LargeNEHStats local;
+    LargeNEHStats& report = stats != nullptr ? *stats : local;
+    report = LargeNEHStats();
+    std::vector<int> initialOrder = flowshop::getSortedJobOrder(instance);
+    bool compact = allowCompact && std::all_of(instance.times.begin(), instance.times.end(), [](int value) {
+        return value >= 0 && value <= UINT16_MAX;
+    });
+    report.compactTimes = compact;
+    return flowshop::withMachineCount(instance.machineCount, [&](auto M) {
+        if (compact) {
+            return large::ChunkedNEH<uint16_t, M()>(instance, report).run(initialOrder);
+        }
+        return large::ChunkedNEH<int, M()>(instance, report).run(initialOrder);
+    });
+}
@@ -1,243 +1,371 @@
+#include <iomanip>
 #include <iostream>
-#include <fstream>
 #include <vector>
-#include <sstream>
 #include <string>
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 #include <limits>
+#include <numeric>
+#include <random>
 
-using namespace std;
-
-
-struct Job {
-    int jobId;
-    vector<int> processingTimes;
-    int totalProcessingTime;
-};
+#include <unistd.h>
 
+#include "../common/benchmark.h"
+#include "../common/flowshop.h"
+#include "../common/instance_archive.h"
+#include "../common/instrumentation.h"
+#include "branch_and_bound.h"
+#include "large_neh.h"
+#include "online_neh.h"
 
-//sort jobs by total processing time
-vector<int> getSortedJobOrder(const vector<Job>& tasks) {
-    vector<Job> sortedTasks = tasks;
-    stable_sort(sortedTasks.begin(), sortedTasks.end(), [](const Job& a, const Job& b) {
-        return a.totalProcessingTime > b.totalProcessingTime;
-    });
-
-    vector<int> jobOrder;
-    transform(sortedTasks.begin(), sortedTasks.end(), back_inserter(jobOrder), [](const Job& task) {
-        return task.jobId - 1;
-    });
-
-    return jobOrder;
-}
+using namespace std;
 
+using flowshop::Instance;
+using flowshop::InstanceView;
+using flowshop::makespan;
+using flowshop::optimizedNEH;
 
-//extract a column from a matrix
-vector<int> getColumn(const vector<vector<int>>& matrix, int col) {
-    int numRows = matrix.size();
-    vector<int> column(numRows, 0);
-    for (int i = 0; i < numRows; ++i) {
-        column[i] = matrix[i][col];
-    }
-    return column;
-}
 
+// Basic NEH algorithm, every candidate position evaluated with a full makespan
+vector<int> basicNEH(const InstanceView& tasks) {
+    vector<int> initialOrder = flowshop::getSortedJobOrder(tasks);
+    vector<int> finalOrder;
+    int bestPos = 0;
 
-//propagate times forward
-void propagateForward(const vector<Job>& tasks, const vector<int>& jobOrder, vector<vector<int>>& forwardMatrix, int start = 0) {
-    int numMachines = tasks[0].processingTimes.size();
-    vector<int> previous(numMachines, 0);
-    if (start != 0) {
-        previous = getColumn(forwardMatrix, jobOrder[start - 1]);
-    }
-    for (int i = start; i < jobOrder.size(); i++) {
-        int time = 0;
-        for (int m = 0; m < numMachines; m++) {
-            time = max(time, previous[m]) + tasks[jobOrder[i]].processingTimes[m];
-            forwardMatrix[m][jobOrder[i]] = time;
-            previous[m] = time;
+    for (int jobIndex : initialOrder) {
+        int currentJobs = finalOrder.size();
+        int minCmax = numeric_limits<int>::max();
+        {
+            INSTRUMENT_PHASE(Evaluate);
+            for (int i = 0; i < currentJobs + 1; i++) {
+                vector<int> newOrder = finalOrder;
+                newOrder.insert(newOrder.begin() + i, jobIndex);
+                int c = makespan(tasks, newOrder);
+                if (c < minCmax) {
+                    minCmax = c;
+                    bestPos = i;
+                }
+            }
         }
+        INSTRUMENT_PHASE(Insert);
+        finalOrder.insert(finalOrder.begin() + bestPos, jobIndex);
     }
+    return finalOrder;
 }
 
 
-//propagate times backward
-void propagateBackward(const vector<Job>& tasks, const vector<int>& jobOrder, vector<vector<int>>& backwardMatrix, int start = -1) {
-    if (jobOrder.empty()) {
+// Text parse against the mapped archive: a full load, and the start-up of a batch that only
+// needs data.100-110 (load, then QNEH on each). The archive lives in a temporary file for
+// the duration of the measurement.
+void measureLoading(benchmark::Suite& suite, const string& filePath, const vector<InstanceView>& datasets) {
+    error_code error;
+    string archivePath = (filesystem::temp_directory_path(error) / "neh-archive-XXXXXX").string();
+    int fd = error ? -1 : mkstemp(&archivePath[0]);
+    if (fd < 0) {
+        cerr << "Error: Cannot create a temporary archive; skipping the loading benchmarks" << endl;
         return;
     }
-    int numMachines = tasks[0].processingTimes.size();
-    vector<int> previous(numMachines, 0);
-    if (start != jobOrder.size() - 1) {
-        previous = getColumn(backwardMatrix, jobOrder[start + 1]);
+    ::close(fd);
+    if (!flowshop::writeArchive(datasets, archivePath)) {
+        cerr << "Error: Cannot write " << archivePath << "; skipping the loading benchmarks" << endl;
+        remove(archivePath.c_str());
+        return;
     }
-    for (int i = start; i >= 0; i--) {
-        int time = 0;
-        for (int m = numMachines - 1; m >= 0; m--) {
-            time = max(time, previous[m]) + tasks[jobOrder[i]].processingTimes[m];
-            backwardMatrix[m][jobOrder[i]] = time;
-            previous[m] = time;
+    string all = to_string(datasets.size()) + " instances";
+    int first = 100;
+    int last = min<int>(110, datasets.size() - 1);
+    string batch = "data." + to_string(first) + "-" + to_string(last);
+
+    suite.measure("load text", all, [&]() {
+        benchmark::keep(flowshop::loadInstances(filePath));
+    });
+    suite.measure("load archive", all, [&]() {
+        benchmark::keep(flowshop::loadArchive(archivePath));
+    });
+    suite.measure("open archive", batch, [&]() {
+        flowshop::Archive archive;
+        archive.open(archivePath);
+        for (int i = first; i <= last; i++) {
+            benchmark::keep(archive.view(i).times[0]);
         }
-    }
+    });
+    suite.measure("startup text", batch, [&]() {
+        vector<Instance> loaded = flowshop::loadInstances(filePath);
+        for (int i = first; i <= last; i++) {
+            benchmark::keep(optimizedNEH(loaded[i]));
+        }
+    });
+    suite.measure("startup archive", batch, [&]() {
+        flowshop::Archive archive;
+        archive.open(archivePath);
+        for (int i = first; i <= last; i++) {
+            benchmark::keep(optimizedNEH(archive.view(i)));
+        }
+    });
+    remove(archivePath.c_str());
 }
 
 
-//calculate Cmax
-int calculateCmax(const Job& task, const vector<vector<int>>& forwardMatrix, const vector<vector<int>>& backwardMatrix, int pos, const vector<int>& jobOrder) {
-    int time = 0;
-    int cmax = 0;
-    int numJobs = jobOrder.size();
-    int numMachines = task.processingTimes.size();
-    vector<int> taskTimes(numMachines, 0);
-    vector<int> previous;
-    if (pos != 0) {
-        previous = getColumn(forwardMatrix, jobOrder[pos - 1]);
-    } else {
-        previous = vector<int>(numMachines, 0);
-    }
-    for (int m = 0; m < numMachines; m++) {
-        time = max(time, previous[m]) + task.processingTimes[m];
-        taskTimes[m] = time;
-        if (pos < numJobs) {
-            int value = taskTimes[m] + backwardMatrix[m][jobOrder[pos]];
-            if (value > cmax) {
-                cmax = value;
-            }
+// One cell per Taillard family (n x m); a sample solves every instance of the family once
+int runBenchmark(const benchmark::Options& options, const string& filePath, const vector<InstanceView>& datasets) {
+    benchmark::Suite suite(options);
+    measureLoading(suite, filePath, datasets);
+    size_t first = 0;
+    while (first < datasets.size()) {
+        size_t last = first;
+        while (last < datasets.size() && datasets[last].jobCount == datasets[first].jobCount &&
+               datasets[last].machineCount == datasets[first].machineCount) {
+            last++;
         }
+        string size = to_string(datasets[first].jobCount) + "x" + to_string(datasets[first].machineCount);
+        // basic NEH is O(n^3 m); beyond 100 jobs a single family takes minutes per sample
+        if (datasets[first].jobCount <= 100) {
+            suite.measure("NEH", size, [&]() {
+                for (size_t i = first; i < last; i++) {
+                    benchmark::keep(basicNEH(datasets[i]));
+                }
+            });
+        }
+        suite.measure("QNEH", size, [&]() {
+            for (size_t i = first; i < last; i++) {
+                benchmark::keep(optimizedNEH(datasets[i]));
+            }
+        });
+        // the same kernels forced onto the runtime machine count, to show the gain of specialising on M
+        suite.measure("QNEH generic", size, [&]() {
+            for (size_t i = first; i < last; i++) {
+                benchmark::keep(flowshop::kernels::optimizedNEH<0>(datasets[i], flowshop::getSortedJobOrder(datasets[i])));
+            }
+        });
+        vector<int> identity(datasets[first].jobCount);
+        iota(identity.begin(), identity.end(), 0);
+        suite.measure("makespan", size, [&]() {
+            for (size_t i = first; i < last; i++) {
+                benchmark::keep(makespan(datasets[i], identity));
+            }
+        });
+        suite.measure("makespan generic", size, [&]() {
+            for (size_t i = first; i < last; i++) {
+                benchmark::keep(flowshop::kernels::makespan<0>(datasets[i], identity.data(), identity.size()));
+            }
+        });
+        first = last;
     }
-    if (pos == numJobs) {
-        return time;
-    }
-    return cmax;
+    return suite.finish();
 }
 
 
-// Optimized NEH algorithm
-vector<int> optimizedNEH(const vector<Job>& tasks) {
-    vector<int> initialOrder = getSortedJobOrder(tasks);
-    vector<int> finalOrder;
-    int numJobs = tasks.size();
-    int numMachines = tasks[0].processingTimes.size();
-    int bestPos = 0;
-    vector<vector<int>> forwardMatrix(numMachines, vector<int>(numJobs, 0));
-    vector<vector<int>> backwardMatrix(numMachines, vector<int>(numJobs, 0));
-
-    for (int jobIndex : initialOrder) {
-        int currentJobs = finalOrder.size();
-        int minCmax = numeric_limits<int>::max();
-        propagateForward(tasks, finalOrder, forwardMatrix, bestPos);
-        propagateBackward(tasks, finalOrder, backwardMatrix, bestPos);
-        for (int i = 0; i < currentJobs + 1; i++) {
-            int c = calculateCmax(tasks[jobIndex], forwardMatrix, backwardMatrix, i, finalOrder);
-            if (c < minCmax) {
-                minCmax = c;
-                bestPos = i;
-            }
+// Certifies NEH against the optimum on the small families (n <= 20, m <= 10)
+int runBranchAndBound(const vector<InstanceView>& datasets, double timeLimit) {
+    cout << "Results for Branch and Bound (time limit " << timeLimit << " s per instance)" << endl;
+    int proven = 0;
+    int attempted = 0;
+    long long totalNodes = 0;
+    double totalSeconds = 0;
+    for (size_t i = 0; i < datasets.size(); i++) {
+        if (datasets[i].jobCount > 20 || datasets[i].machineCount > 10) {
+            continue;
         }
-        finalOrder.insert(finalOrder.begin() + bestPos, jobIndex);
+        attempted++;
+        int nehCmax = makespan(datasets[i], optimizedNEH(datasets[i]));
+        BranchAndBoundResult result = BranchAndBound(datasets[i], timeLimit).solve();
+        totalNodes += result.nodes;
+        totalSeconds += result.seconds;
+        proven += result.proven;
+
+        cout << "data." << i << ": Cmax: " << result.cmax << (result.proven ? " (optimal)" : " (time limit)");
+        cout << " NEH: " << nehCmax << " gap: " << 100.0 * (nehCmax - result.cmax) / result.cmax << "%";
+        cout << " root LB: " << result.rootBound;
+        cout << " nodes: " << result.nodes;
+        cout << " nodes/s: " << static_cast<long long>(result.seconds > 0 ? result.nodes / result.seconds : 0);
+        cout << " Execution Time: " << result.seconds << " seconds" << endl;
     }
-    return finalOrder;
+    cout << "Proven optima: " << proven << "/" << attempted << endl;
+    cout << "Average nodes/s: " << static_cast<long long>(totalSeconds > 0 ? totalNodes / totalSeconds : 0) << endl;
+    return 0;
 }
 
 
-//compute final Cmax
-int finalCmax(const vector<Job>& tasks, const vector<int>& jobOrder) {
-    int numMachines = tasks[0].processingTimes.size();
-    int cmax = 0;
-    vector<int> previous(numMachines, 0);
-    for (int jobIndex : jobOrder) {
-        int time = 0;
-        for (int m = 0; m < numMachines; m++) {
-            time = max(time, previous[m]) + tasks[jobIndex].processingTimes[m];
-            previous[m] = time;
-            cmax = time;
+// Streams jobs into OnlineNEH. Fed in NEH order the scheduler must reproduce QNEH on every
+// instance; on random U[1, 99] streams it reports per-arrival and per-removal latency at
+// steady state, where every arrival follows the completion of the first job in sequence.
+int runOnline(const vector<InstanceView>& datasets) {
+    int mismatches = 0;
+    for (const InstanceView& instance : datasets) {
+        OnlineNEH online(instance.machineCount);
+        for (int job : flowshop::getSortedJobOrder(instance)) {
+            online.insert(instance.job(job));
+        }
+        if (online.makespan() != makespan(instance, optimizedNEH(instance))) {
+            mismatches++;
         }
     }
-    return cmax;
-}
+    cout << "Online NEH replaying QNEH on " << datasets.size() << " instances, mismatches: " << mismatches << endl;
+
+    const int operations = 2000;
+    cout << fixed << setprecision(1);
+    for (int machineCount : {5, 20}) {
+        for (int jobCount : {1000, 10000, 100000}) {
+            mt19937 random(jobCount + machineCount);
+            uniform_int_distribution<int> duration(1, 99);
+            vector<int> durations(machineCount);
+            auto draw = [&]() {
+                for (int& value : durations) {
+                    value = duration(random);
+                }
+                return durations.data();
+            };
 
+            OnlineNEH online(machineCount);
+            for (int j = 0; j < jobCount; j++) {
+                online.insert(draw());
+            }
+            vector<double> arrivals;
+            vector<double> removals;
+            for (int i = 0; i < operations; i++) {
+                auto start = chrono::steady_clock::now();
+                online.remove(online.sequence().front());
+                auto middle = chrono::steady_clock::now();
+                online.insert(draw());
+                auto end = chrono::steady_clock::now();
+                removals.push_back(chrono::duration<double, micro>(middle - start).count());
+                arrivals.push_back(chrono::duration<double, micro>(end - middle).count());
+            }
+            bool consistent = online.makespan() == makespan(online.jobs(), online.sequence());
+            mismatches += !consistent;
+
+            cout << "n = " << setw(6) << jobCount << ", m = " << setw(2) << machineCount << ": arrival p50 "
+                 << setw(9) << benchmark::detail::percentile(arrivals, 0.5) << " us, p99 " << setw(9)
+                 << benchmark::detail::percentile(arrivals, 0.99) << " us; removal p50 " << setw(9)
+                 << benchmark::detail::percentile(removals, 0.5) << " us, p99 " << setw(9)
+                 << benchmark::detail::percentile(removals, 0.99) << " us" << (consistent ? "" : " INCONSISTENT")
+                 << endl;
+        }
+    }
+    return mismatches == 0 ? 0 : 1;
+}
 
-// Basic NEH algorithm
-vector<int> basicNEH(const vector<Job>& tasks) {
-    vector<int> initialOrder = getSortedJobOrder(tasks);
-    vector<int> finalOrder;
-    int numJobs = tasks.size();
-    int numMachines = tasks[0].processingTimes.size();
-    int bestPos = 0;
 
-    for (int jobIndex : initialOrder) {
-        int currentJobs = finalOrder.size();
-        int minCmax = numeric_limits<int>::max();
-        for (int i = 0; i < currentJobs + 1; i++) {
-            vector<int> newOrder = finalOrder;
-            newOrder.insert(newOrder.begin() + i, jobIndex);
-            int c = finalCmax(tasks, newOrder);
-            if (c < minCmax) {
-                minCmax = c;
-                bestPos = i;
+// Flat QNEH against the chunked large-instance NEH on random U[1, 99] instances with 50
+// machines. Traffic is modelled from the rows each pass streams (see LargeNEHStats); for
+// QNEH that is the head rows rebuilt behind the previous insertion, every tail row, and
+// a head and a tail row per scored position, taking the insertion points from the
+// chunked run, which makes the same choices. The 20000-job row alone takes about two minutes.
+int runLarge() {
+    const int machineCount = 50;
+    cout << fixed << setprecision(2);
+    cout << setw(7) << "n" << setw(12) << "QNEH s" << setw(10) << "GB/s" << setw(10) << "MB" << setw(12) << "chunked s"
+         << setw(10) << "GB/s" << setw(12) << "16-bit s" << setw(10) << "GB/s" << setw(10) << "MB" << endl;
+    int mismatches = 0;
+    for (int jobCount : {500, 1000, 2000, 5000, 10000, 20000}) {
+        mt19937 random(jobCount);
+        uniform_int_distribution<int> duration(1, 99);
+        Instance instance;
+        instance.jobCount = jobCount;
+        instance.machineCount = machineCount;
+        instance.times.resize(static_cast<size_t>(jobCount) * machineCount);
+        instance.totalTimes.assign(jobCount, 0);
+        for (int j = 0; j < jobCount; j++) {
+            for (int k = 0; k < machineCount; k++) {
+                int value = duration(random);
+                instance.times[static_cast<size_t>(j) * machineCount + k] = value;
+                instance.totalTimes[j] += value;
             }
         }
-        finalOrder.insert(finalOrder.begin() + bestPos, jobIndex);
+
+        auto start = chrono::steady_clock::now();
+        vector<int> flat = optimizedNEH(instance);
+        double flatSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        LargeNEHStats wide;
+        start = chrono::steady_clock::now();
+        vector<int> chunked = largeNEH(instance, false, &wide);
+        double wideSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        LargeNEHStats compact;
+        start = chrono::steady_clock::now();
+        vector<int> compactOrder = largeNEH(instance, true, &compact);
+        double compactSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        double row = 4.0 * machineCount;
+        double steps = static_cast<double>(jobCount) * (jobCount - 1) / 2;
+        double headRows = steps - (wide.tailRowsUpdated - jobCount);
+        double flatBytes = headRows * 2 * row + steps * 2 * row + (steps + jobCount) * 2 * row;
+        double flatMegabytes = 2.0 * (jobCount + 1) * row / (1 << 20);
+
+        bool same = flat == chunked && flat == compactOrder;
+        mismatches += !same;
+        cout << setw(7) << jobCount << setw(12) << flatSeconds << setw(10) << flatBytes / flatSeconds / 1e9 << setw(10)
+             << flatMegabytes << setw(12) << wideSeconds << setw(10) << wide.trafficBytes(machineCount) / wideSeconds / 1e9
+             << setw(12) << compactSeconds << setw(10) << compact.trafficBytes(machineCount) / compactSeconds / 1e9
+             << setw(10) << compact.storageBytes / double(1 << 20) << (same ? "" : " MISMATCH") << endl;
     }
-    return finalOrder;
+    return mismatches == 0 ? 0 : 1;
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
     string filePath = "neh.data.txt";
-    ifstream file(filePath);
-    vector<vector<Job>> datasets;
-    string line;
-
-    if (!file.is_open()) {
-        cerr << "Error: Cannot open file: " << filePath << endl;
+    string archivePath;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (string(argv[i]) == "--archive") {
+            archivePath = argv[i + 1];
+        }
+    }
+    // the kernels run on views, straight into the mapping when the instances come from an archive
+    vector<Instance> parsed;
+    flowshop::Archive archive;
+    vector<InstanceView> datasets;
+    if (archivePath.empty()) {
+        parsed = flowshop::loadInstances(filePath);
+        datasets = flowshop::viewInstances(parsed);
+    } else if (archive.open(archivePath)) {
+        datasets = flowshop::viewInstances(archive);
+    }
+    if (datasets.empty()) {
         return 1;
     }
 
-    vector<Job> currentDataset;
-    bool isSavingData = false;
-    int taskCounter = 0;
-
-    while (getline(file, line)) {
-        if (line.empty()) {
-            isSavingData = false;
-            if (!currentDataset.empty()) {
-                datasets.push_back(currentDataset);
-                currentDataset.clear();
-            }
-            continue;
+    benchmark::Options benchmarkOptions = benchmark::parseOptions(argc, argv);
+    if (benchmarkOptions.enabled) {
+        return runBenchmark(benchmarkOptions, filePath, datasets);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--large") {
+            return runLarge();
         }
-        if (line.find("data.") != string::npos) {
-            isSavingData = true;
-            taskCounter = 0;
-        } else {
-            if (isSavingData) {
-                if (taskCounter == 0) {
-                    taskCounter++;
-                    continue;
-                }
-                istringstream iss(line);
-                int num;
-                int totalTimes = 0;
-                vector<int> taskTimes;
-                while (iss >> num) {
-                    totalTimes += num;
-                    taskTimes.push_back(num);
+        if (string(argv[i]) == "--online") {
+            return runOnline(datasets);
+        }
+        if (string(argv[i]) == "--branch-and-bound") {
+            // optional time limit in seconds; a following option is left for its own parser
+            double timeLimit = 10.0;
+            if (i + 1 < argc && string(argv[i + 1]).compare(0, 2, "--") != 0) {
+                char* end = nullptr;
+                timeLimit = strtod(argv[i + 1], &end);
+                if (end == argv[i + 1] || *end != '\0' || !(timeLimit > 0)) {
+                    cerr << "Usage: main --branch-and-bound [seconds], got: " << argv[i + 1] << endl;
+                    return 1;
                 }
-                currentDataset.push_back({taskCounter, taskTimes, totalTimes});
-                taskCounter++;
+                ++i;
             }
+            return runBranchAndBound(datasets, timeLimit);
+        }
+        if (string(argv[i]) == "--write-archive" && i + 1 < argc) {
+            if (!flowshop::writeArchive(datasets, argv[i + 1])) {
+                return 1;
+            }
+            cout << "Wrote " << datasets.size() << " instances to " << argv[i + 1] << endl;
+            return 0;
         }
     }
-    if (!currentDataset.empty()) {
-        datasets.push_back(currentDataset);
-    }
-
-    file.close();
+    INSTRUMENT_REPORT(cout, "load");
 
     int dataStart = 0;
-    int dataEnd = 120;
+    int dataEnd = min<int>(120, datasets.size() - 1);
     cout << "Results for NEH" << endl;
 
     chrono::duration<double> totalExecutionTime = chrono::duration<double>::zero();
@@ -249,8 +377,9 @@ int main() {
         chrono::duration<double> duration = end - start;
 
         totalExecutionTime += duration;
-        cout << finalCmax(datasets[i], result) << " ";
+        cout << makespan(datasets[i], result) << " ";
         cout << "Execution Time: " << duration.count() << " seconds" << endl;
+        INSTRUMENT_REPORT(cout, "NEH data." + to_string(i));
     }
     cout << "Total execution time for NEH: " << totalExecutionTime.count() << " seconds" << endl;
 
@@ -264,10 +393,12 @@ int main() {
         chrono::duration<double> duration = end - start;
 
         totalExecutionTime += duration;
-        cout << finalCmax(datasets[i], result) << " ";
+        cout << makespan(datasets[i], result) << " ";
         cout << "Execution Time: " << duration.count() << " seconds" << endl;
+        INSTRUMENT_REPORT(cout, "QNEH data." + to_string(i));
     }
     cout << "Total execution time for QNEH: " << totalExecutionTime.count() << " seconds" << endl;
+    INSTRUMENT_SUMMARY(cout);
 
     return 0;
 }
@@ -0,0 +1,103 @@
+#pragma once
+
+// Online NEH: jobs arrive one at a time and are inserted at the position that minimises
+// the makespan of the current sequence, the same step optimizedNEH applies to a sorted job
+// list, without rebuilding the schedule.
+//
+// The scheduler keeps the permutation together with its head and tail matrices (layout as
+// in flowshop.h: heads row p + 1 and tails row p describe position p). Inserting at
+// position p scores all n + 1 positions in one pass, then recomputes head rows from p
+// onward and tail rows up to p; the tail rows behind p are only shifted. Removal does the
+// same around the freed position. Each update is one O(n * m) pass split at the touched
+// position instead of the O(n^2 * m) of rerunning NEH.
+
+#include <algorithm>
+#include <vector>
+
+#include "../common/flowshop.h"
+
+class OnlineNEH {
+public:
+    explicit OnlineNEH(int machineCount) : heads(machineCount, 0), tails(machineCount, 0) {
+        instance.machineCount = machineCount;
+    }
+
+    int size() const {
+        return static_cast<int>(order.size());
+    }
+
+    int makespan() const {
+        return heads[static_cast<size_t>(order.size()) * instance.machineCount + instance.machineCount - 1];
+    }
+
+    // Job handles in processing order; durations of a handle are jobs().job(handle)
+    const std::vector<int>& sequence() const {
+        return order;
+    }
+
+    const flowshop::Instance& jobs() const {
+        return instance;
+    }
+
+    // Adds a job with `durations[machineCount]` at its best position; returns its handle,
+    // which stays valid until the job is removed
+    int insert(const int* durations) {
+        const int m = instance.machineCount;
+        int job = allocate(durations);
+        int length = size();
+        int position = flowshop::bestInsertion(instance, job, heads.data(), tails.data(), length);
+
+        order.insert(order.begin() + position, job);
+        heads.resize(static_cast<size_t>(length + 2) * m);
+        flowshop::computeHeads(instance, order.data(), length + 1, heads.data(), position);
+        tails.insert(tails.begin() + static_cast<size_t>(position) * m, m, 0);
+        flowshop::computeTails(instance, order.data(), length + 1, tails.data(), position);
+        return job;
+    }
+
+    // Drops a completed or cancelled job; false when the handle is not scheduled
+    bool remove(int job) {
+        const int m = instance.machineCount;
+        auto found = std::find(order.begin(), order.end(), job);
+        if (found == order.end()) {
+            return false;
+        }
+        int position = static_cast<int>(found - order.begin());
+        order.erase(found);
+        int length = size();
+        heads.resize(static_cast<size_t>(length + 1) * m);
+        flowshop::computeHeads(instance, order.data(), length, heads.data(), position);
+        tails.erase(tails.begin() + static_cast<size_t>(position) * m, tails.begin() + static_cast<size_t>(position + 1) * m);
+        flowshop::computeTails(instance, order.data(), length, tails.data(), position - 1);
+        freeSlots.push_back(job);
+        return true;
+    }
+
+private:
+    // Stores the durations in a free slot of the job table, growing it when none is left
+    int allocate(const int* durations) {
+        const int m = instance.machineCount;
+        int job;
+        if (!freeSlots.empty()) {
+            job = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            job = instance.jobCount++;
+            instance.times.resize(static_cast<size_t>(instance.jobCount) * m);
+            instance.totalTimes.resize(instance.jobCount);
+        }
+        std::copy(durations, durations + m, instance.times.begin() + static_cast<size_t>(job) * m);
+        int total = 0;
+        for (int k = 0; k < m; k++) {
+            total += durations[k];
+        }
+        instance.totalTimes[job] = total;
+        return job;
+    }
+
+    flowshop::Instance instance; // job table indexed by handle
+    std::vector<int> freeSlots;
+    std::vector<int> order;
+    std::vector<int> heads;
+    std::vector<int> tails;
+};
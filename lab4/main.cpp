@@ -1,7 +1,7 @@
 #include <iostream>
+#include <iomanip>
 #include <fstream>
 #include <vector>
-#include <sstream>
 #include <string>
 #include <algorithm>
 #include <chrono>
@@ -9,204 +9,288 @@
 #include <cstdlib>
 #include <numeric>
 #include <climits>
+#include <limits>
+
+#include "../common/annealing.h"
+#include "../common/benchmark.h"
+#include "../common/flowshop.h"
+#include "../common/instance_archive.h"
+#include "../common/instrumentation.h"
+#include "../common/metaheuristics.h"
+#include "../common/problems.h"
 
 using namespace std;
 
-struct WorkUnit {
-    int unitID;
-    vector<int> durations;
-    int totalDuration;
-};
-
-vector<int> shuffleOrder(const vector<int>& originalOrder) {
-    vector<int> modifiedOrder = originalOrder;
-    int firstPosition = rand() % originalOrder.size();
-    int secondPosition;
-    do {
-        secondPosition = rand() % originalOrder.size();
-    } while (firstPosition == secondPosition);
-    swap(modifiedOrder[firstPosition], modifiedOrder[secondPosition]);
-    return modifiedOrder;
-}
+using flowshop::Instance;
+using flowshop::InstanceView;
 
-int computeMaxDuration(const vector<WorkUnit>& units, const vector<int>& sequence) {
-    int machineCount = units[0].durations.size();
-    int maxDuration = 0;
-    vector<int> lastCompletion(machineCount, 0);
-    for (int idx : sequence) {
-        int duration = 0;
-        for (int m = 0; m < machineCount; m++) {
-            duration = max(duration, lastCompletion[m]) + units[idx].durations[m];
-            lastCompletion[m] = duration;
-            maxDuration = duration;
+// Time at which a run first reached `target`, or -1 when it never did
+double secondsToReach(const meta::Result& result, long long target) {
+    for (const auto& improvement : result.improvements) {
+        if (improvement.second <= target) {
+            return improvement.first;
         }
     }
-    return maxDuration;
+    return -1.0;
 }
 
-vector<int> performAnnealing(const vector<WorkUnit>& units, int cycles, double initialTemp, double reductionFactor) {
-    vector<int> sequence(units.size());
-    ofstream output("results.csv", ofstream::out);
-
-    for (size_t i = 0; i < sequence.size(); i++) {
-        sequence[i] = i;
-    }
-
-    int currentMax = computeMaxDuration(units, sequence);
-
-    srand(static_cast<unsigned int>(time(nullptr)));
-
-    double temperature = initialTemp;
-
-    for (int i = 0; i < cycles; i++) {
-        vector<int> newSequence = shuffleOrder(sequence);
-
-        int newMax = computeMaxDuration(units, newSequence);
-        int change = newMax - currentMax;
-
-        if (change < 0) {
-            sequence = newSequence;
-            currentMax = newMax;
-        } else {
-            double chance = exp(-change / temperature);
-            if (static_cast<double>(rand()) / RAND_MAX < chance) {
-                sequence = newSequence;
-                currentMax = newMax;
-            }
-        }
-        if (i % 100 == 0) {
-            output << i << ", " << currentMax << endl;
+// Best cost a run had reached by `seconds`
+long long bestAt(const meta::Result& result, double seconds) {
+    long long best = result.improvements.front().second;
+    for (const auto& improvement : result.improvements) {
+        if (improvement.first > seconds) {
+            break;
         }
-
-        temperature *= reductionFactor;
+        best = improvement.second;
     }
-    output.close();
-    return sequence;
+    return best;
 }
 
-pair<double, double> defineTemperatures(int maxChange, int minChange) {
-    if (maxChange <= 0 || minChange <= 0) {
-        throw invalid_argument("maxChange and minChange must be greater than 0.");
+// One cell per Taillard family, timed on its first instance from the NEH warm start with a
+// fixed seed so that every sample performs the same moves
+int runBenchmark(const benchmark::Options& options, const vector<InstanceView>& dataSets, int totalCycles) {
+    benchmark::Suite suite(options);
+    MoveMix mix = {0.2, 0.6, 0.2, 4};
+    for (size_t i = 0; i < dataSets.size(); i++) {
+        const InstanceView& units = dataSets[i];
+        if (i != 0 && units.jobCount == dataSets[i - 1].jobCount && units.machineCount == dataSets[i - 1].machineCount) {
+            continue;
+        }
+        Random random(static_cast<unsigned int>(i));
+        meta::AnnealingSettings settings = calibrateAnnealing(units, totalCycles, mix, random);
+        vector<int> nehSequence = flowshop::optimizedNEH(units);
+
+        string size = to_string(units.jobCount) + "x" + to_string(units.machineCount);
+        suite.measure("Annealing", size, [&]() {
+            Random random(static_cast<unsigned int>(i));
+            meta::FlowShopProblem problem(units, nehSequence);
+            benchmark::keep(meta::anneal(problem, settings, random).cost);
+        });
     }
-    double upperTemp = -maxChange / log(0.9);
-    double lowerTemp = -minChange / log(0.1);
-    return {upperTemp, lowerTemp};
+    return suite.finish();
 }
 
-double determineCoolingRate(double upperTemp, double lowerTemp, int cycles) {
-    if (upperTemp <= 0 || lowerTemp <= 0) {
-        throw invalid_argument("upperTemp and lowerTemp must be greater than 0.");
+// Quality versus time of tabu search and annealing, both started from NEH; tabu gets the
+// wall time that the annealing run took, and both are sampled at the same checkpoints
+int runTabuComparison(const vector<InstanceView>& dataSets, int totalCycles) {
+    const double fractions[] = {0.05, 0.1, 0.25, 0.5, 1.0};
+    MoveMix mix = {0.2, 0.6, 0.2, 4};
+    long long annealingTotal[5] = {};
+    long long tabuTotal[5] = {};
+    int endData = min<int>(120, dataSets.size() - 1);
+
+    cout << "Tabu Search vs Simulated Annealing - best Cmax at fractions of the annealing run time" << endl;
+    for (int i = 100; i <= endData; i++) {
+        Random random(static_cast<unsigned int>(i));
+        meta::AnnealingSettings annealingSettings = calibrateAnnealing(dataSets[i], totalCycles, mix, random);
+        vector<int> nehSequence = flowshop::optimizedNEH(dataSets[i]);
+
+        auto startTime = chrono::steady_clock::now();
+        meta::FlowShopProblem problem(dataSets[i], nehSequence);
+        meta::Result annealing = meta::anneal(problem, annealingSettings, random);
+        double budget = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+        meta::TabuSettings tabuSettings;
+        tabuSettings.iterations = numeric_limits<long long>::max();
+        tabuSettings.timeLimitSeconds = budget;
+        problem.assign(nehSequence);
+        meta::Result tabu = meta::tabuSearch(problem, tabuSettings);
+
+        cout << "data." << i << ": NEH: " << flowshop::makespan(dataSets[i], nehSequence) << " | Time: " << budget << " s"
+             << " | Tabu evaluations: " << tabu.evaluations << endl;
+        cout << "  Annealing:";
+        for (int f = 0; f < 5; f++) {
+            long long best = bestAt(annealing, fractions[f] * budget);
+            annealingTotal[f] += best;
+            cout << " " << best;
+        }
+        cout << endl << "  Tabu:     ";
+        for (int f = 0; f < 5; f++) {
+            long long best = bestAt(tabu, fractions[f] * budget);
+            tabuTotal[f] += best;
+            cout << " " << best;
+        }
+        cout << endl;
     }
-    return pow(lowerTemp / upperTemp, 1.0 / cycles);
+    cout << "Total at 5% / 10% / 25% / 50% / 100% of the budget" << endl;
+    cout << "  Annealing:";
+    for (int f = 0; f < 5; f++) {
+        cout << " " << annealingTotal[f];
+    }
+    cout << endl << "  Tabu:     ";
+    for (int f = 0; f < 5; f++) {
+        cout << " " << tabuTotal[f];
+    }
+    cout << endl;
+    return 0;
 }
 
-pair<int, int> computeDeltaExtremes(const vector<WorkUnit>& units, int alterations) {
-    vector<int> sequence(units.size());
-    for (size_t i = 0; i < sequence.size(); i++) sequence[i] = i;
-
-    int currentMax = computeMaxDuration(units, sequence);
-    int maxDelta = INT_MIN;
-    int minDelta = INT_MAX;
-
-    for (int i = 0; i < alterations; i++) {
-        vector<int> newSequence = shuffleOrder(sequence);
-        int newMax = computeMaxDuration(units, newSequence);
-        int delta = abs(newMax - currentMax);
-
-        if (delta >= maxDelta) maxDelta = delta;
-        if (delta <= minDelta) minDelta = delta;
-
-        currentMax = newMax;
+// The generic annealing, iterated local search and tabu search (metaheuristics.h) from NEH
+// on the flow-shop adapter, annealing with the calibrated temperatures; each reported Cmax
+// is recomputed from its order.
+int runMetaheuristics(const vector<InstanceView>& dataSets) {
+    const char* names[] = {"Annealing", "ILS", "Tabu"};
+    long long evaluations[3] = {};
+    double seconds[3] = {};
+    long long totals[3] = {};
+    int mismatches = 0;
+    int endData = min<int>(110, dataSets.size() - 1);
+    cout << fixed << setprecision(0);
+    for (int i = 100; i <= endData; i++) {
+        vector<int> nehSequence = flowshop::optimizedNEH(dataSets[i]);
+        meta::FlowShopProblem problem(dataSets[i], nehSequence);
+        Random calibration(static_cast<unsigned int>(i));
+        meta::AnnealingSettings defaults;
+        meta::AnnealingSettings annealingSettings = calibrateAnnealing(dataSets[i], defaults.iterations, defaults.mix, calibration);
+        cout << "data." << i << ": NEH: " << problem.cost();
+        for (int a = 0; a < 3; a++) {
+            Random random(static_cast<unsigned int>(i));
+            problem.assign(nehSequence);
+            meta::Result result = a == 0   ? meta::anneal(problem, annealingSettings, random)
+                                  : a == 1 ? meta::iteratedLocalSearch(problem, meta::LocalSearchSettings(), random)
+                                           : meta::tabuSearch(problem, meta::TabuSettings());
+            int cmax = flowshop::makespan(dataSets[i], result.order);
+            if (cmax != result.cost || problem.cost() != result.cost) {
+                cout << " MISMATCH (" << names[a] << " reported " << result.cost << ", actual " << cmax << ")";
+                mismatches++;
+            }
+            cout << " | " << names[a] << ": " << cmax;
+            evaluations[a] += result.evaluations;
+            seconds[a] += result.seconds;
+            totals[a] += cmax;
+        }
+        cout << endl;
     }
-
-    if (minDelta == 0) minDelta = 1;
-    return {maxDelta, minDelta};
+    for (int a = 0; a < 3; a++) {
+        cout << left << setw(10) << names[a] << right << " Total Cmax: " << totals[a]
+             << " | evaluations/s: " << evaluations[a] / seconds[a] << endl;
+    }
+    cout << "Mismatches: " << mismatches << endl;
+    return mismatches == 0 ? 0 : 1;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     string filePath = "neh.data.txt";
-    ifstream dataFile(filePath);
-    vector<vector<WorkUnit>> dataSets;
-    string fileLine;
-
-    if (!dataFile.is_open()) {
-        cerr << "Failed to open file: " << filePath << endl;
+    string archivePath;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (string(argv[i]) == "--archive") {
+            archivePath = argv[i + 1];
+        }
+    }
+    // the kernels run on views, straight into the mapping when the instances come from an archive
+    vector<Instance> parsed;
+    flowshop::Archive archive;
+    vector<InstanceView> dataSets;
+    if (archivePath.empty()) {
+        parsed = flowshop::loadInstances(filePath);
+        dataSets = flowshop::viewInstances(parsed);
+    } else if (archive.open(archivePath)) {
+        dataSets = flowshop::viewInstances(archive);
+    }
+    if (dataSets.empty()) {
         return 1;
     }
 
-    vector<WorkUnit> currentData;
-    bool shouldSave = false;
-    int itemCounter = 0;
-
-    while (getline(dataFile, fileLine)) {
-        if (fileLine.empty()) {
-            shouldSave = false;
-            if (!currentData.empty()) {
-                dataSets.push_back(currentData);
-                currentData.clear();
-            }
-            continue;
+    benchmark::Options benchmarkOptions = benchmark::parseOptions(argc, argv);
+    if (benchmarkOptions.enabled) {
+        return runBenchmark(benchmarkOptions, dataSets, 100000);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--tabu") {
+            return runTabuComparison(dataSets, 100000);
         }
-
-        if (fileLine.find("data.") != string::npos) {
-            shouldSave = true;
-            itemCounter = 0;
-        } else {
-            if (shouldSave) {
-                if (itemCounter == 0) {
-                    itemCounter++;
-                    continue;
-                }
-                istringstream lineStream(fileLine);
-                int number;
-                int sumDurations = 0;
-                vector<int> taskDurations;
-                while (lineStream >> number) {
-                    sumDurations += number;
-                    taskDurations.push_back(number);
-                }
-                currentData.push_back({itemCounter, taskDurations, sumDurations});
-                itemCounter++;
-            }
+        if (string(argv[i]) == "--metaheuristics") {
+            return runMetaheuristics(dataSets);
         }
     }
-
-    if (!currentData.empty()) {
-        dataSets.push_back(currentData);
-    }
-
-    dataFile.close();
+    INSTRUMENT_REPORT(cout, "load");
 
     int startData = 100;
-    int endData = 110;
-
-    cout << "Simulated Annealing - Results" << endl;
-
-    chrono::duration<double> totalTime = chrono::duration<double>::zero();
+    int endData = min<int>(110, dataSets.size() - 1);
 
     int totalCycles = 100000;
 
-    for (int i = startData; i <= endData; i++) {
-        auto extremes = computeDeltaExtremes(dataSets[i], 1000);
-
-        auto temps = defineTemperatures(extremes.first, extremes.second);
-        
-        double startTemp = temps.first;
-        double coolRate = determineCoolingRate(startTemp, temps.second, totalCycles);
-
-        auto startTime = chrono::high_resolution_clock::now();
-        vector<int> result = performAnnealing(dataSets[i], totalCycles, startTemp, coolRate);
-        auto endTime = chrono::high_resolution_clock::now();
-        chrono::duration<double> duration = endTime - startTime;
+    struct Variant {
+        string name;
+        bool warmStart;
+        MoveMix mix;
+    };
+    vector<Variant> variants = {
+        {"identity + swap", false, {1.0, 0.0, 0.0, 4}},
+        {"NEH + swap", true, {1.0, 0.0, 0.0, 4}},
+        {"NEH + insert", true, {0.0, 1.0, 0.0, 4}},
+        {"NEH + mixed", true, {0.2, 0.6, 0.2, 4}},
+    };
+
+    for (const Variant& variant : variants) {
+        cout << "Simulated Annealing (" << variant.name << ") - Results" << endl;
+
+        chrono::duration<double> totalTime = chrono::duration<double>::zero();
+        long long totalMax = 0;
+
+        for (int i = startData; i <= endData; i++) {
+            Random random(static_cast<unsigned int>(i));
+            meta::AnnealingSettings settings = calibrateAnnealing(dataSets[i], totalCycles, variant.mix, random);
+            double startTemp = settings.initialTemperature;
+            double coolRate = determineCoolingRate(startTemp, settings.finalTemperature, totalCycles);
+
+            vector<int> nehSequence = flowshop::optimizedNEH(dataSets[i]);
+            int nehMax = flowshop::makespan(dataSets[i], nehSequence);
+            // NEH+1% compares cold against warm starts (a warm start holds it from the first
+            // move); the other two lie below the NEH start, so warm runs are timed on real progress
+            int nearNehMax = nehMax + nehMax / 100;
+            int targetMax = nehMax - nehMax / 100;
+
+            vector<int> initialSequence(dataSets[i].jobCount);
+            iota(initialSequence.begin(), initialSequence.end(), 0);
+            if (variant.warmStart) {
+                initialSequence = nehSequence;
+            }
 
-        totalTime += duration;
+            ofstream trace("results.csv");
+            settings.trace = &trace;
+            auto startTime = chrono::high_resolution_clock::now();
+            meta::FlowShopProblem problem(dataSets[i], initialSequence);
+            meta::Result result = meta::anneal(problem, settings, random);
+            auto endTime = chrono::high_resolution_clock::now();
+            chrono::duration<double> duration = endTime - startTime;
+            double secondsToNearNeh = secondsToReach(result, nearNehMax);
+            double secondsToBeatNeh = secondsToReach(result, nehMax - 1);
+            double secondsToTarget = secondsToReach(result, targetMax);
+
+            totalTime += duration;
+            int resultMax = flowshop::makespan(dataSets[i], result.order);
+            totalMax += resultMax;
+
+            cout << "data." << i << ": Cmax: " << resultMax << " ";
+            cout << "| NEH: " << nehMax << " ";
+            cout << "| Time: " << duration.count() << " s ";
+            cout << "| To NEH+1%: ";
+            if (secondsToNearNeh < 0) {
+                cout << "not reached ";
+            } else {
+                cout << secondsToNearNeh << " s ";
+            }
+            cout << "| Below NEH: ";
+            if (secondsToBeatNeh < 0) {
+                cout << "not reached ";
+            } else {
+                cout << secondsToBeatNeh << " s ";
+            }
+            cout << "| To NEH-1%: ";
+            if (secondsToTarget < 0) {
+                cout << "not reached ";
+            } else {
+                cout << secondsToTarget << " s ";
+            }
+            cout << "| Start Temp: " << startTemp << " | Cooling Rate: " << coolRate << endl;
+            INSTRUMENT_REPORT(cout, variant.name + " data." + to_string(i));
+        }
 
-        cout << "data." << i << ": Cmax: " << computeMaxDuration(dataSets[i], result) << " ";
-        cout << "| Time: " << duration.count() << " s ";
-        cout << "| Start Temp: " << startTemp << " | Cooling Rate: " << coolRate << endl;
+        cout << "Total Cmax: " << totalMax << endl;
+        cout << "Total Execution Time: " << totalTime.count() << " s" << endl;
     }
-
-    cout << "Total Execution Time: " << totalTime.count() << " s" << endl;
+    INSTRUMENT_SUMMARY(cout);
 
     return 0;
 }
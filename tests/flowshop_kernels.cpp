@@ -0,0 +1,214 @@
+// Cross-engine check of the flow-shop kernels: makespan, optimizedNEH, the annealing
+// IncrementalEvaluator and meta::FlowShopProblem are compared against a naive
+// reference on random instances (generic and unrolled machine counts) and on every
+// instance of neh.data.txt, whose "neh:" values QNEH must also reproduce. Tabu search
+// through FlowShopProblem's insertion scan must take the same path as through delta().
+//
+//   g++ -std=c++17 -O2 -Wall -o flowshop_kernels flowshop_kernels.cpp
+//   ./flowshop_kernels [path/to/neh.data.txt]
+//
+// Prints each failure and exits non-zero if there is any.
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../common/annealing.h"
+#include "../common/flowshop.h"
+#include "../common/moves.h"
+#include "../common/problems.h"
+
+using namespace std;
+
+using flowshop::Instance;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const string& what) {
+    if (!condition) {
+        cout << "FAIL " << what << endl;
+        failures++;
+    }
+}
+
+// Completion-time table of the textbook recurrence, one full pass per call
+int naiveMakespan(const Instance& instance, const vector<int>& order) {
+    if (order.empty()) {
+        return 0;
+    }
+    vector<vector<int>> completion(order.size(), vector<int>(instance.machineCount, 0));
+    for (size_t p = 0; p < order.size(); p++) {
+        for (int m = 0; m < instance.machineCount; m++) {
+            int ready = max(p > 0 ? completion[p - 1][m] : 0, m > 0 ? completion[p][m - 1] : 0);
+            completion[p][m] = ready + instance.job(order[p])[m];
+        }
+    }
+    return completion.back().back();
+}
+
+// NEH scoring every candidate position with a full makespan; the first best position wins ties
+vector<int> naiveNEH(const Instance& instance) {
+    vector<int> jobs(instance.jobCount);
+    iota(jobs.begin(), jobs.end(), 0);
+    stable_sort(jobs.begin(), jobs.end(), [&](int a, int b) {
+        return instance.totalTimes[a] > instance.totalTimes[b];
+    });
+    vector<int> order;
+    for (int job : jobs) {
+        int bestPos = 0;
+        int bestCmax = INT_MAX;
+        for (size_t pos = 0; pos <= order.size(); pos++) {
+            vector<int> candidate = order;
+            candidate.insert(candidate.begin() + pos, job);
+            int cmax = naiveMakespan(instance, candidate);
+            if (cmax < bestCmax) {
+                bestCmax = cmax;
+                bestPos = pos;
+            }
+        }
+        order.insert(order.begin() + bestPos, job);
+    }
+    return order;
+}
+
+// FlowShopProblem without its bestInsertion, so tabuSearch falls back to one delta() per move
+class DeltaOnlyProblem {
+public:
+    DeltaOnlyProblem(const Instance& instance, const vector<int>& order) : problem(instance, order) {}
+
+    int size() const {
+        return problem.size();
+    }
+    long long cost() const {
+        return problem.cost();
+    }
+    long long delta(const Move& move) {
+        return problem.delta(move);
+    }
+    void apply(const Move& move) {
+        problem.apply(move);
+    }
+    void undo(const Move& move) {
+        problem.undo(move);
+    }
+    const vector<int>& order() const {
+        return problem.order();
+    }
+    void assign(const vector<int>& order) {
+        problem.assign(order);
+    }
+
+private:
+    meta::FlowShopProblem problem;
+};
+
+Instance randomInstance(int jobCount, int machineCount, Random& random) {
+    Instance instance;
+    instance.jobCount = jobCount;
+    instance.machineCount = machineCount;
+    instance.times.resize(static_cast<size_t>(jobCount) * machineCount);
+    instance.totalTimes.assign(jobCount, 0);
+    for (int j = 0; j < jobCount; j++) {
+        for (int m = 0; m < machineCount; m++) {
+            int value = 1 + randomBelow(random, 99);
+            instance.times[static_cast<size_t>(j) * machineCount + m] = value;
+            instance.totalTimes[j] += value;
+        }
+    }
+    return instance;
+}
+
+void checkInstance(const Instance& instance, const string& name, int moves, Random& random) {
+    vector<int> order(instance.jobCount);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), random);
+    check(flowshop::makespan(instance, order) == naiveMakespan(instance, order), name + ": makespan");
+
+    vector<int> neh = flowshop::optimizedNEH(instance);
+    vector<int> reference = naiveNEH(instance);
+    check(neh == reference, name + ": optimizedNEH order differs from naive NEH");
+    int nehCmax = naiveMakespan(instance, neh);
+    check(instance.referenceMakespan == 0 || nehCmax == instance.referenceMakespan,
+          name + ": optimizedNEH Cmax " + to_string(nehCmax) + ", file says " + to_string(instance.referenceMakespan));
+
+    if (instance.jobCount < 2) {
+        return;
+    }
+    // both incremental engines walk the same random moves, each accepted with probability 1/2
+    MoveMix mix;
+    mix.swapWeight = 1.0;
+    mix.insertWeight = 1.0;
+    mix.blockWeight = 1.0;
+    IncrementalEvaluator evaluator(instance, order);
+    meta::FlowShopProblem problem(instance, order);
+    vector<int> current = order;
+    for (int i = 0; i < moves; i++) {
+        Move move = drawMove(instance.jobCount, mix, random);
+        vector<int> moved = current;
+        applyMove(moved, move);
+        int expected = naiveMakespan(instance, moved);
+        string where = name + ": move " + to_string(i);
+        check(evaluator.evaluate(move) == expected, where + " IncrementalEvaluator::evaluate");
+        check(problem.cost() + problem.delta(move) == expected, where + " FlowShopProblem::delta");
+        if (randomBelow(random, 2) == 0) {
+            evaluator.accept(move);
+            problem.apply(move);
+            current = moved;
+        } else {
+            problem.apply(move);
+            problem.undo(move);
+        }
+        check(evaluator.currentSequence() == current && problem.order() == current, where + " sequence");
+        check(evaluator.makespan() == naiveMakespan(instance, current), where + " IncrementalEvaluator::makespan");
+        check(problem.cost() == naiveMakespan(instance, current), where + " FlowShopProblem::cost");
+    }
+
+    meta::TabuSettings settings;
+    settings.iterations = 30;
+    meta::FlowShopProblem scanned(instance, order);
+    DeltaOnlyProblem delta(instance, order);
+    meta::Result fast = meta::tabuSearch(scanned, settings);
+    meta::Result slow = meta::tabuSearch(delta, settings);
+    check(fast.order == slow.order && fast.improvements.size() == slow.improvements.size(),
+          name + ": tabu search differs between bestInsertion and delta()");
+    check(fast.cost == naiveMakespan(instance, fast.order), name + ": tabu search cost");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    string filePath = argc > 1 ? argv[1] : "../lab3/neh.data.txt";
+    Random random(2024);
+
+    int checked = 0;
+    for (int machineCount : {1, 3, 5, 7, 10, 20}) {
+        for (int jobCount : {1, 2, 3, 8, 25}) {
+            Instance instance = randomInstance(jobCount, machineCount, random);
+            checkInstance(instance, "random " + to_string(jobCount) + "x" + to_string(machineCount), 200, random);
+            checked++;
+        }
+    }
+
+    vector<Instance> datasets = flowshop::loadInstances(filePath);
+    check(!datasets.empty(), "no instances in " + filePath);
+    for (const Instance& instance : datasets) {
+        // the naive NEH is O(n^3 m): the largest Taillard instances are left to the QNEH/file check
+        if (instance.jobCount > 100) {
+            vector<int> neh = flowshop::optimizedNEH(instance);
+            check(instance.referenceMakespan == 0 || naiveMakespan(instance, neh) == instance.referenceMakespan,
+                  "data." + to_string(instance.id) + ": optimizedNEH Cmax differs from the file");
+        } else {
+            checkInstance(instance, "data." + to_string(instance.id), 50, random);
+        }
+        checked++;
+    }
+
+    cout << checked << " instances checked, " << failures << " failures" << endl;
+    return failures == 0 ? 0 : 1;
+}